@@ -27,5 +27,19 @@ HEADERS += \
     ../include/detail/pixel_convertor.hxx \
     ../include/detail/pixel_walker.hxx \
     ../include/detail/pixel_iterator.hxx \
+    ../include/detail/tile_view.hxx \
+    ../include/detail/pixel_pipeline.hxx \
+    ../include/detail/pixel_rows.hxx \
+    ../include/detail/c_api.hxx \
+    ../include/detail/plane_helper.hxx \
+    ../include/detail/pixel_checksum.hxx \
+    ../include/detail/pixel_mosaic.hxx \
+    ../include/detail/pixel_scaler.hxx \
+    ../include/detail/pixel_mask.hxx \
+    ../include/detail/ycc_helper.hxx \
+    ../include/detail/hdr_convertor.hxx \
+    ../include/detail/color_lut.hxx \
+    ../include/detail/bayer_helper.hxx \
     ../include/rgb2yuv_old.hpp \
-    ../include/rgb2yuv.hpp
+    ../include/rgb2yuv.hpp \
+    ../include/rgb2yuv.h
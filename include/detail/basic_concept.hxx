@@ -11,6 +11,19 @@ typedef          GLB_ uint8_t               byte_t;
 typedef struct { GLB_ uint8_t b_, g_, r_; } rgb_t;
 typedef struct { GLB_ uint8_t v_, u_, y_; } yuv_t;
 
+typedef struct { GLB_ uint16_t b_, g_, r_; } rgb16_t; // high bit depth
+typedef struct { GLB_ uint16_t v_, u_, y_; } yuv16_t;
+
+/*
+ * The planes of a frame in memory order (e.g. NV12: Y, CbCr; YV12: Y, Cr, Cb),
+ * each with the bytes from the start of a row to the next (its stride, or pitch).
+ */
+struct frame_planes
+{
+    byte_t *    data_[3];
+    GLB_ size_t pitch_[3];
+};
+
 enum supported
 {
     rgb_MIN,
@@ -19,8 +32,28 @@ enum supported
     rgb_555,
     rgb_444,
     rgb_888X,
+    rgb_161616,          // 48-bit, 16 bits per channel
     rgb_MAX,
 
+    idx_MIN,
+    idx_8,               // 8-bit palette indices, up to 256 colors
+    idx_MAX,
+
+    bayer_MIN,
+    bayer_RGGB,          // 8-bit raw
+    bayer_BGGR,
+    bayer_GRBG,
+    bayer_GBRG,
+    bayer_RGGB10,        // MIPI CSI-2 RAW10, 4 pixels in 5 bytes
+    bayer_BGGR10,
+    bayer_GRBG10,
+    bayer_GBRG10,
+    bayer_RGGB12,        // MIPI CSI-2 RAW12, 2 pixels in 3 bytes
+    bayer_BGGR12,
+    bayer_GRBG12,
+    bayer_GBRG12,
+    bayer_MAX,
+
     /*
      * YUV Formats Chapter 2. Image Formats
      * See: http://www.retiisi.org.uk/v4l2/tmp/media_api/yuv-formats.html
@@ -46,7 +79,33 @@ enum supported
     yuv_411P,            // 411 P
     yuv_YVU9,            // 410 P
     yuv_YUV9,
-    yuv_MAX
+    yuv_MB16,            // 420 SP, block ordered: each block is Y then CbCr interleaved
+    yuv_MB32,
+    yuv_MB64,            // e.g. 64x64 CTU
+    yuv_P010,            // 420 SP, 16-bit words with 10 bits in the MSBs
+    yuv_Y800,            // luma only (grey)
+    yuv_GREY = yuv_Y800,
+    yuv_MAX,
+
+    /*
+     * Reversible (or nearly) color transforms, 4:4:4 planar
+     */
+    ycc_MIN,
+    ycc_YCoCg,           // Y Co Cg, 8-bit planes, Co/Cg with an offset of 128 (lossy)
+    ycc_YCoCgR,          // Y Co Cg, int16 planes, Co/Cg take 9 bits (lossless)
+    ycc_RCT,             // Y Cb Cr, int16 planes, JPEG 2000 reversible transform (lossless)
+    ycc_ICT,             // Y Cb Cr, int16 planes, JPEG 2000 irreversible transform
+    ycc_MAX,
+
+    /*
+     * JPEG ready blocks: full range YCbCr (JFIF, the transform of ycc_ICT),
+     * level shifted (-128) int16 8x8 blocks in MCU order,
+     * MCU444: Y Cb Cr, MCU420: Y0 Y1 Y2 Y3 Cb Cr (Cb Cr averaged over 2x2)
+     */
+    jpg_MIN,
+    jpg_MCU444,
+    jpg_MCU420,
+    jpg_MAX
 };
 
 enum plane_type
@@ -66,6 +125,10 @@ enum plane_type
 /// Useful tools for SFINAE
 ////////////////////////////////////////////////////////////////
 
+template <bool... B> struct all_of;
+template <>                     struct all_of<>           { enum { value = 1 }; };
+template <bool B, bool... Bs>   struct all_of<B, Bs...>   { enum { value = (B && all_of<Bs...>::value) ? 1 : 0 }; };
+
 template <R2Y_ supported S> struct is_rgb
 {
     enum { value = ((S > rgb_MIN) && (S < rgb_MAX)) ? 1 : 0 };
@@ -76,6 +139,31 @@ template <R2Y_ supported S> struct is_yuv
     enum { value = ((S > yuv_MIN) && (S < yuv_MAX)) ? 1 : 0 };
 };
 
+template <R2Y_ supported S> struct is_idx
+{
+    enum { value = ((S > idx_MIN) && (S < idx_MAX)) ? 1 : 0 };
+};
+
+template <R2Y_ supported S> struct is_bayer
+{
+    enum { value = ((S > bayer_MIN) && (S < bayer_MAX)) ? 1 : 0 };
+};
+
+template <R2Y_ supported S> struct is_ycc
+{
+    enum { value = ((S > ycc_MIN) && (S < ycc_MAX)) ? 1 : 0 };
+};
+
+template <R2Y_ supported S> struct is_jpg
+{
+    enum { value = ((S > jpg_MIN) && (S < jpg_MAX)) ? 1 : 0 };
+};
+
+template <R2Y_ supported S> struct block_size                 { enum { value = 1  }; };
+template <>                  struct block_size<R2Y_ yuv_MB16> { enum { value = 16 }; };
+template <>                  struct block_size<R2Y_ yuv_MB32> { enum { value = 32 }; };
+template <>                  struct block_size<R2Y_ yuv_MB64> { enum { value = 64 }; };
+
 template <R2Y_ plane_type P> struct is_rgb_plane               { enum { value = 0 }; };
 template <>                  struct is_rgb_plane<R2Y_ plane_R> { enum { value = 1 }; };
 template <>                  struct is_rgb_plane<R2Y_ plane_G> { enum { value = 1 }; };
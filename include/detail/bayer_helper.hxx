@@ -0,0 +1,201 @@
+/*
+    rgb2yuv - Code covered by the MIT License
+    Author: mutouyun (http://orzz.org)
+*/
+
+namespace detail_bayer_ {
+
+/* Bayer patterns, position of the red site in each 2x2 cell */
+
+template <R2Y_ supported> struct pattern;
+
+template <> struct pattern<R2Y_ bayer_RGGB> { enum { rx = 0, ry = 0 }; };
+template <> struct pattern<R2Y_ bayer_BGGR> { enum { rx = 1, ry = 1 }; };
+template <> struct pattern<R2Y_ bayer_GRBG> { enum { rx = 1, ry = 0 }; };
+template <> struct pattern<R2Y_ bayer_GBRG> { enum { rx = 0, ry = 1 }; };
+
+template <> struct pattern<R2Y_ bayer_RGGB10> : pattern<R2Y_ bayer_RGGB> {};
+template <> struct pattern<R2Y_ bayer_BGGR10> : pattern<R2Y_ bayer_BGGR> {};
+template <> struct pattern<R2Y_ bayer_GRBG10> : pattern<R2Y_ bayer_GRBG> {};
+template <> struct pattern<R2Y_ bayer_GBRG10> : pattern<R2Y_ bayer_GBRG> {};
+template <> struct pattern<R2Y_ bayer_RGGB12> : pattern<R2Y_ bayer_RGGB> {};
+template <> struct pattern<R2Y_ bayer_BGGR12> : pattern<R2Y_ bayer_BGGR> {};
+template <> struct pattern<R2Y_ bayer_GRBG12> : pattern<R2Y_ bayer_GRBG> {};
+template <> struct pattern<R2Y_ bayer_GBRG12> : pattern<R2Y_ bayer_GBRG> {};
+
+/* Rows of 8-bit samples, stored one by one */
+
+template <typename P>
+struct plain_rows
+{
+    typedef P sample_t;
+    enum { shift = 0 };
+
+    plain_rows(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t /*in_h*/, GLB_ size_t /*in_rows*/)
+        : data_(reinterpret_cast<P const *>(in_data)), w_(in_w)
+    {}
+
+    R2Y_FORCE_INLINE_ P const * row(GLB_ size_t y)
+    {
+        return data_ + (y * w_);
+    }
+
+private:
+    P const *   data_;
+    GLB_ size_t w_;
+};
+
+/*
+ * MIPI CSI-2 packings.
+ * The high bits of each pixel come first, followed by one byte of packed low bits:
+ * RAW10: P0[9:2] P1[9:2] P2[9:2] P3[9:2] (P3[1:0] P2[1:0] P1[1:0] P0[1:0])
+ * RAW12: P0[11:4] P1[11:4] (P1[3:0] P0[3:0])
+ */
+
+template <int Bits> struct packing;
+
+template <> struct packing<10>
+{
+    enum { pixels = 4, bytes = 5 };
+
+    R2Y_FORCE_INLINE_ static void unpack(R2Y_ byte_t const * in_p, GLB_ uint16_t * ot_p, GLB_ size_t in_w)
+    {
+        for (GLB_ size_t i = 0; i < in_w; i += pixels, in_p += bytes, ot_p += pixels)
+        {
+            GLB_ uint8_t lsb = in_p[4];
+            ot_p[0] = static_cast<GLB_ uint16_t>( (in_p[0] << 2) | ( lsb       & 3) );
+            ot_p[1] = static_cast<GLB_ uint16_t>( (in_p[1] << 2) | ((lsb >> 2) & 3) );
+            ot_p[2] = static_cast<GLB_ uint16_t>( (in_p[2] << 2) | ((lsb >> 4) & 3) );
+            ot_p[3] = static_cast<GLB_ uint16_t>( (in_p[3] << 2) | ( lsb >> 6     ) );
+        }
+    }
+};
+
+template <> struct packing<12>
+{
+    enum { pixels = 2, bytes = 3 };
+
+    R2Y_FORCE_INLINE_ static void unpack(R2Y_ byte_t const * in_p, GLB_ uint16_t * ot_p, GLB_ size_t in_w)
+    {
+        for (GLB_ size_t i = 0; i < in_w; i += pixels, in_p += bytes, ot_p += pixels)
+        {
+            GLB_ uint8_t lsb = in_p[2];
+            ot_p[0] = static_cast<GLB_ uint16_t>( (in_p[0] << 4) | (lsb & 0x0F) );
+            ot_p[1] = static_cast<GLB_ uint16_t>( (in_p[1] << 4) | (lsb >> 4  ) );
+        }
+    }
+};
+
+/*
+ * Rows of packed samples.
+ * Each row is unpacked once into a small ring of 16-bit rows,
+ * which covers all the rows a walk step may touch and stays in cache,
+ * so there is no separate unpacking pass over the frame.
+ */
+template <int Bits>
+class packed_rows
+{
+    typedef R2Y_ detail_bayer_::packing<Bits> packing_t;
+
+    R2Y_ byte_t const *             data_;
+    GLB_ size_t                     w_, stride_, mask_;
+    R2Y_ scope_block<GLB_ uint16_t> ring_;
+    R2Y_ scope_block<GLB_ size_t>   tags_;
+
+public:
+    typedef GLB_ uint16_t sample_t;
+    enum { shift = Bits - 8 };
+
+    /* in_rows: how many consecutive rows are needed at the same time */
+    packed_rows(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t /*in_h*/, GLB_ size_t in_rows)
+        : data_(in_data), w_(in_w)
+        , stride_((in_w / packing_t::pixels) * packing_t::bytes)
+        , mask_(1)
+    {
+        assert((in_w % packing_t::pixels) == 0);
+        while (mask_ < in_rows) mask_ <<= 1;
+        ring_.reset(mask_ * in_w);
+        tags_.reset(mask_);
+        for (GLB_ size_t i = 0; i < mask_; ++i) tags_[i] = static_cast<GLB_ size_t>(-1);
+        --mask_;
+    }
+
+    R2Y_FORCE_INLINE_ GLB_ uint16_t const * row(GLB_ size_t y)
+    {
+        GLB_ size_t slot = y & mask_;
+        GLB_ uint16_t * ot_p = ring_.data() + (slot * w_);
+        if (tags_[slot] != y)
+        {
+            packing_t::unpack(data_ + (y * stride_), ot_p, w_);
+            tags_[slot] = y;
+        }
+        return ot_p;
+    }
+};
+
+/*
+ * Mirror the coordinate at the borders.
+ * Reflecting (instead of clamping) keeps the color of the neighbour site.
+ */
+R2Y_FORCE_INLINE_ GLB_ size_t reflect(GLB_ size_t i, GLB_ size_t n)
+{
+    return (i == static_cast<GLB_ size_t>(-1)) ? 1 : ((i >= n) ? (n - 2) : i);
+}
+
+/*
+ * Bilinear demosaic of one pixel.
+ * Each channel is kept as the sum of 4 samples until the final shift.
+ */
+template <R2Y_ supported S, typename Rows>
+class demosaic
+{
+    typedef R2Y_ detail_bayer_::pattern<S> pattern_t;
+
+    Rows        rows_;
+    GLB_ size_t w_, h_;
+
+    R2Y_FORCE_INLINE_ static GLB_ uint8_t scale(GLB_ int32_t sum4)
+    {
+        GLB_ int32_t value = (sum4 + (2 << Rows::shift)) >> (2 + Rows::shift);
+        return static_cast<GLB_ uint8_t>( (value > 0xFF) ? 0xFF : value );
+    }
+
+public:
+    demosaic(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, GLB_ size_t in_rows)
+        : rows_(in_data, in_w, in_h, in_rows), w_(in_w), h_(in_h)
+    {
+        assert(in_w >= 2 && in_h >= 2);
+    }
+
+    R2Y_FORCE_INLINE_ R2Y_ rgb_t operator()(GLB_ size_t x, GLB_ size_t y)
+    {
+        typedef typename Rows::sample_t sample_t;
+        sample_t const * r0 = rows_.row(reflect(y - 1, h_));
+        sample_t const * r1 = rows_.row(y);
+        sample_t const * r2 = rows_.row(reflect(y + 1, h_));
+        GLB_ size_t xl = reflect(x - 1, w_), xr = reflect(x + 1, w_);
+
+        GLB_ int32_t c     =  r1[x] << 2;
+        GLB_ int32_t cross =  r0[x]  + r2[x]  + r1[xl] + r1[xr];
+        GLB_ int32_t diag  =  r0[xl] + r0[xr] + r2[xl] + r2[xr];
+        GLB_ int32_t horz  = (r1[xl] + r1[xr]) << 1;
+        GLB_ int32_t vert  = (r0[x]  + r2[x] ) << 1;
+
+        bool r_row = ((y & 1) == static_cast<GLB_ size_t>(pattern_t::ry));
+        bool r_col = ((x & 1) == static_cast<GLB_ size_t>(pattern_t::rx));
+        R2Y_ rgb_t pix;
+        if (r_row)
+        {
+            if (r_col) { pix.r_ = scale(c);     pix.g_ = scale(cross); pix.b_ = scale(diag); } // R
+            else       { pix.r_ = scale(horz);  pix.g_ = scale(c);     pix.b_ = scale(vert); } // G on R row
+        }
+        else
+        {
+            if (r_col) { pix.r_ = scale(vert);  pix.g_ = scale(c);     pix.b_ = scale(horz); } // G on B row
+            else       { pix.r_ = scale(diag);  pix.g_ = scale(cross); pix.b_ = scale(c);    } // B
+        }
+        return pix;
+    }
+};
+
+} // namespace detail_bayer_
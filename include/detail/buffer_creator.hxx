@@ -7,6 +7,15 @@
 /// Create a buffer for transforming the image pixels
 ////////////////////////////////////////////////////////////////
 
+/*
+ * The samples of a plane subsampled by (in_sx, in_sy),
+ * the partial blocks on the right and bottom edges are rounded up.
+ */
+inline GLB_ size_t plane_size(GLB_ size_t in_w, GLB_ size_t in_h, GLB_ size_t in_sx, GLB_ size_t in_sy)
+{
+    return ((in_w + in_sx - 1) / in_sx) * ((in_h + in_sy - 1) / in_sy);
+}
+
 /* Calculate RGB size */
 
 template <R2Y_ supported S>
@@ -37,6 +46,50 @@ GLB_ size_t>::type calculate_size(GLB_ size_t in_w, GLB_ size_t in_h)
     return (in_w * in_h) * sizeof(GLB_ uint32_t);
 }
 
+template <R2Y_ supported S>
+typename STD_ enable_if<(S == R2Y_ rgb_161616),
+GLB_ size_t>::type calculate_size(GLB_ size_t in_w, GLB_ size_t in_h)
+{
+    return (in_w * in_h) * sizeof(R2Y_ rgb16_t);
+}
+
+/* Calculate indexed size */
+
+template <R2Y_ supported S>
+typename STD_ enable_if<(S == R2Y_ idx_8),
+GLB_ size_t>::type calculate_size(GLB_ size_t in_w, GLB_ size_t in_h)
+{
+    return (in_w * in_h);
+}
+
+/* Calculate bayer size */
+
+template <R2Y_ supported S>
+typename STD_ enable_if<(S == R2Y_ bayer_RGGB || S == R2Y_ bayer_BGGR ||
+                         S == R2Y_ bayer_GRBG || S == R2Y_ bayer_GBRG),
+GLB_ size_t>::type calculate_size(GLB_ size_t in_w, GLB_ size_t in_h)
+{
+    return (in_w * in_h);
+}
+
+template <R2Y_ supported S>
+typename STD_ enable_if<(S == R2Y_ bayer_RGGB10 || S == R2Y_ bayer_BGGR10 ||
+                         S == R2Y_ bayer_GRBG10 || S == R2Y_ bayer_GBRG10),
+GLB_ size_t>::type calculate_size(GLB_ size_t in_w, GLB_ size_t in_h)
+{
+    assert((in_w & 3) == 0); // in_w % 4 == 0
+    return (in_w * in_h) + ((in_w * in_h) >> 2);
+}
+
+template <R2Y_ supported S>
+typename STD_ enable_if<(S == R2Y_ bayer_RGGB12 || S == R2Y_ bayer_BGGR12 ||
+                         S == R2Y_ bayer_GRBG12 || S == R2Y_ bayer_GBRG12),
+GLB_ size_t>::type calculate_size(GLB_ size_t in_w, GLB_ size_t in_h)
+{
+    assert((in_w & 1) == 0); // in_w % 2 == 0
+    return (in_w * in_h) + ((in_w * in_h) >> 1);
+}
+
 /* Calculate YUV size */
 
 template <R2Y_ supported S>
@@ -46,43 +99,118 @@ GLB_ size_t>::type calculate_size(GLB_ size_t in_w, GLB_ size_t in_h)
     return (in_w * in_h) * sizeof(R2Y_ yuv_t);
 }
 
+/*
+ * Packed: each row is padded to whole macro pixels.
+ * Planar: the chroma planes are rounded up on the edges.
+ */
+
 template <R2Y_ supported S>
-typename STD_ enable_if<(S == R2Y_ yuv_YVYU || S == R2Y_ yuv_UYVY || S == R2Y_ yuv_VYUY || 
-                         S == R2Y_ yuv_YUY2 || S == R2Y_ yuv_422P),
+typename STD_ enable_if<(S == R2Y_ yuv_YVYU || S == R2Y_ yuv_UYVY || S == R2Y_ yuv_VYUY || S == R2Y_ yuv_YUY2),
 GLB_ size_t>::type calculate_size(GLB_ size_t in_w, GLB_ size_t in_h)
 {
-    GLB_ size_t s = in_w * in_h;
-    assert((s & 1) == 0); // s % 2 == 0
-    return (s << 1);
+    return ((in_w + 1) >> 1) * 4 * in_h;  // 2 pixels in 4 bytes
+}
+
+template <R2Y_ supported S>
+typename STD_ enable_if<(S == R2Y_ yuv_422P),
+GLB_ size_t>::type calculate_size(GLB_ size_t in_w, GLB_ size_t in_h)
+{
+    return (in_w * in_h) + (plane_size(in_w, in_h, 2, 1) << 1);
 }
 
 template <R2Y_ supported S>
 typename STD_ enable_if<(S == R2Y_ yuv_Y41P),
 GLB_ size_t>::type calculate_size(GLB_ size_t in_w, GLB_ size_t in_h)
 {
-    GLB_ size_t s = in_w * in_h;
-    assert((s & 7) == 0); // s % 8 == 0
-    return ( s + (s >> 1) );
+    return ((in_w + 7) >> 3) * 12 * in_h; // 8 pixels in 12 bytes
+}
+
+template <R2Y_ supported S>
+typename STD_ enable_if<(S == R2Y_ yuv_Y411),
+GLB_ size_t>::type calculate_size(GLB_ size_t in_w, GLB_ size_t in_h)
+{
+    return ((in_w + 3) >> 2) * 6 * in_h;  // 4 pixels in 6 bytes
+}
+
+template <R2Y_ supported S>
+typename STD_ enable_if<(S == R2Y_ yuv_411P),
+GLB_ size_t>::type calculate_size(GLB_ size_t in_w, GLB_ size_t in_h)
+{
+    return (in_w * in_h) + (plane_size(in_w, in_h, 4, 1) << 1);
 }
 
 template <R2Y_ supported S>
-typename STD_ enable_if<(S == R2Y_ yuv_Y411 || S == R2Y_ yuv_411P ||
-                         S == R2Y_ yuv_YV12 || S == R2Y_ yuv_YU12 ||
+typename STD_ enable_if<(S == R2Y_ yuv_YV12 || S == R2Y_ yuv_YU12 ||
                          S == R2Y_ yuv_NV12 || S == R2Y_ yuv_NV21),
 GLB_ size_t>::type calculate_size(GLB_ size_t in_w, GLB_ size_t in_h)
 {
+    return (in_w * in_h) + (plane_size(in_w, in_h, 2, 2) << 1);
+}
+
+template <R2Y_ supported S>
+typename STD_ enable_if<(S == R2Y_ yuv_YVU9 || S == R2Y_ yuv_YUV9),
+GLB_ size_t>::type calculate_size(GLB_ size_t in_w, GLB_ size_t in_h)
+{
+    return (in_w * in_h) + (plane_size(in_w, in_h, 4, 4) << 1);
+}
+
+template <R2Y_ supported S>
+typename STD_ enable_if<(S == R2Y_ yuv_MB16 || S == R2Y_ yuv_MB32 || S == R2Y_ yuv_MB64),
+GLB_ size_t>::type calculate_size(GLB_ size_t in_w, GLB_ size_t in_h)
+{
+    GLB_ size_t n = R2Y_ block_size<S>::value;
+    assert((in_w % n) == 0 && (in_h % n) == 0);
     GLB_ size_t s = in_w * in_h;
-    assert((s & 3) == 0); // s % 4 == 0
     return ( s + (s >> 1) );
 }
 
 template <R2Y_ supported S>
-typename STD_ enable_if<(S == R2Y_ yuv_YVU9 || S == R2Y_ yuv_YUV9),
+typename STD_ enable_if<(S == R2Y_ yuv_P010),
+GLB_ size_t>::type calculate_size(GLB_ size_t in_w, GLB_ size_t in_h)
+{
+    return ( (in_w * in_h) + (plane_size(in_w, in_h, 2, 2) << 1) ) * sizeof(GLB_ uint16_t);
+}
+
+template <R2Y_ supported S>
+typename STD_ enable_if<(S == R2Y_ yuv_Y800),
+GLB_ size_t>::type calculate_size(GLB_ size_t in_w, GLB_ size_t in_h)
+{
+    return (in_w * in_h);
+}
+
+/* Calculate YCoCg size */
+
+template <R2Y_ supported S>
+typename STD_ enable_if<(S == R2Y_ ycc_YCoCg),
+GLB_ size_t>::type calculate_size(GLB_ size_t in_w, GLB_ size_t in_h)
+{
+    return (in_w * in_h) * 3;
+}
+
+template <R2Y_ supported S>
+typename STD_ enable_if<(S == R2Y_ ycc_YCoCgR || S == R2Y_ ycc_RCT || S == R2Y_ ycc_ICT),
+GLB_ size_t>::type calculate_size(GLB_ size_t in_w, GLB_ size_t in_h)
+{
+    return (in_w * in_h) * 3 * sizeof(GLB_ int16_t);
+}
+
+/* Calculate JPEG blocks size */
+
+template <R2Y_ supported S>
+typename STD_ enable_if<(S == R2Y_ jpg_MCU444),
+GLB_ size_t>::type calculate_size(GLB_ size_t in_w, GLB_ size_t in_h)
+{
+    assert((in_w & 7) == 0 && (in_h & 7) == 0); // 8x8 MCU
+    return (in_w * in_h) * 3 * sizeof(GLB_ int16_t);
+}
+
+template <R2Y_ supported S>
+typename STD_ enable_if<(S == R2Y_ jpg_MCU420),
 GLB_ size_t>::type calculate_size(GLB_ size_t in_w, GLB_ size_t in_h)
 {
+    assert((in_w & 15) == 0 && (in_h & 15) == 0); // 16x16 MCU
     GLB_ size_t s = in_w * in_h;
-    assert((s & 15) == 0); // s % 16 == 0
-    return ( s + (s >> 3) );
+    return ( s + (s >> 1) ) * sizeof(GLB_ int16_t);
 }
 
 /* Create a buffer with given w & h */
@@ -0,0 +1,223 @@
+/*
+    rgb2yuv - Code covered by the MIT License
+    Author: mutouyun (http://orzz.org)
+*/
+
+////////////////////////////////////////////////////////////////
+/// The C interface, see rgb2yuv.h
+////////////////////////////////////////////////////////////////
+
+#include "../rgb2yuv.h"
+
+namespace R2Y_NAMESPACE_ {
+namespace detail_capi_ {
+
+typedef void (* convert_fn)(R2Y_ frame_planes const & in_f, GLB_ size_t in_w, GLB_ size_t in_h, R2Y_ frame_planes const & ot_f);
+typedef GLB_ size_t (* layout_fn)(GLB_ size_t in_w, GLB_ size_t in_h, R2Y_ detail_layout_::plane_t (& ot_p)[3]);
+
+/* The formats in the order of the values of r2y_format, starting from 1 */
+template <R2Y_ supported... Ss>
+struct format_list
+{
+    enum : GLB_ size_t { size = sizeof...(Ss) };
+};
+
+typedef R2Y_ detail_capi_::format_list<R2Y_ rgb_888, R2Y_ rgb_565, R2Y_ rgb_555, R2Y_ rgb_888X,
+                                       R2Y_ yuv_NV24, R2Y_ yuv_NV42,
+                                       R2Y_ yuv_YUY2, R2Y_ yuv_YVYU, R2Y_ yuv_UYVY, R2Y_ yuv_VYUY, R2Y_ yuv_422P,
+                                       R2Y_ yuv_YV12, R2Y_ yuv_I420, R2Y_ yuv_NV12, R2Y_ yuv_NV21, R2Y_ yuv_Y800> formats;
+
+template <R2Y_ supported S>
+struct readable : STD_ integral_constant<bool, (S != R2Y_ yuv_422P)> {};
+
+template <R2Y_ supported S>
+struct writable : STD_ integral_constant<bool, (S != R2Y_ rgb_565) && (S != R2Y_ rgb_555)> {};
+
+/* The same format is copied plane by plane, without a convert_fn */
+template <R2Y_ supported In, R2Y_ supported Ot,
+          bool = (In != Ot) && R2Y_ detail_capi_::readable<In>::value && R2Y_ detail_capi_::writable<Ot>::value>
+struct converter
+{
+    static R2Y_ detail_capi_::convert_fn get(void) { return NULL; }
+};
+
+template <R2Y_ supported In, R2Y_ supported Ot>
+struct converter<In, Ot, true>
+{
+    static void run(R2Y_ frame_planes const & in_f, GLB_ size_t in_w, GLB_ size_t in_h, R2Y_ frame_planes const & ot_f)
+    {
+        R2Y_ detail_walker_::foreach_xy(in_w, in_h, R2Y_ detail_walker_::make_pixels<In>(in_f, in_w, in_h, 1),
+                                        R2Y_ do_planar_t<Ot>{ ot_f, in_w, in_h });
+    }
+
+    static R2Y_ detail_capi_::convert_fn get(void) { return &run; }
+};
+
+template <typename L>
+struct dispatch;
+
+/* A table of (in, ot) -> convert_fn, instantiated once for every pair */
+template <R2Y_ supported... Ss>
+struct dispatch<R2Y_ detail_capi_::format_list<Ss...>>
+{
+    template <R2Y_ supported In>
+    static R2Y_ detail_capi_::convert_fn convert_from(GLB_ size_t ot_i)
+    {
+        static R2Y_ detail_capi_::convert_fn const fns[] = { R2Y_ detail_capi_::converter<In, Ss>::get()... };
+        return fns[ot_i];
+    }
+
+    static R2Y_ detail_capi_::convert_fn convert(GLB_ size_t in_i, GLB_ size_t ot_i)
+    {
+        static R2Y_ detail_capi_::convert_fn (* const rows[])(GLB_ size_t) = { &convert_from<Ss>... };
+        return rows[in_i](ot_i);
+    }
+
+    static R2Y_ detail_capi_::layout_fn layout(GLB_ size_t i)
+    {
+        static R2Y_ detail_capi_::layout_fn const fns[] = { &R2Y_ detail_layout_::layout<Ss>... };
+        return fns[i];
+    }
+};
+
+typedef R2Y_ detail_capi_::dispatch<R2Y_ detail_capi_::formats> dispatch_t;
+
+/* The index of a r2y_format in formats, or formats::size if it's unknown */
+inline GLB_ size_t index_of(r2y_format fmt)
+{
+    GLB_ size_t i = static_cast<GLB_ size_t>(fmt) - 1;
+    return (i < R2Y_ detail_capi_::formats::size) ? i : R2Y_ detail_capi_::formats::size;
+}
+
+/*
+ * One side of a plan: the planes of a tight frame and the strides of the caller's frame.
+ * The walkers and iterators step over the strides themselves, so nothing is copied.
+ */
+struct side_t
+{
+    R2Y_ detail_layout_::plane_t planes_[3];
+    GLB_ size_t                    count_;
+    GLB_ size_t                    pitch_[3];
+    bool                           strided_; // the planes are given one by one, with pitch_
+
+    int reset(GLB_ size_t fmt_i, GLB_ size_t in_w, GLB_ size_t in_h, GLB_ size_t const * strides)
+    {
+        count_   = R2Y_ detail_capi_::dispatch_t::layout(fmt_i)(in_w, in_h, planes_);
+        strided_ = (strides != NULL);
+        for (GLB_ size_t i = 0; i < count_; ++i)
+        {
+            pitch_[i] = strided_ ? strides[i] : planes_[i].row_;
+            if (pitch_[i] < planes_[i].row_) return R2Y_ERROR_ARGUMENT;
+        }
+        return R2Y_OK;
+    }
+
+    /* The plane i of the caller's frame */
+    R2Y_ byte_t * plane(void const * const * planes, GLB_ size_t i) const
+    {
+        R2Y_ byte_t * base = static_cast<R2Y_ byte_t *>(const_cast<void *>(planes[strided_ ? i : 0]));
+        return strided_ ? base : (base + planes_[i].offset_);
+    }
+
+    R2Y_ frame_planes frame(void const * const * planes) const
+    {
+        R2Y_ frame_planes ret = {};
+        for (GLB_ size_t i = 0; i < count_; ++i)
+        {
+            ret.data_ [i] = this->plane(planes, i);
+            ret.pitch_[i] = pitch_[i];
+        }
+        return ret;
+    }
+
+    bool check(void const * const * planes) const
+    {
+        if (planes == NULL) return false;
+        for (GLB_ size_t i = 0; i < (strided_ ? count_ : 1); ++i)
+        {
+            if (planes[i] == NULL) return false;
+        }
+        return true;
+    }
+};
+
+} // namespace detail_capi_
+} // namespace R2Y_NAMESPACE_
+
+struct r2y_plan
+{
+    R2Y_ detail_capi_::convert_fn fn_; // NULL if the formats are the same
+    GLB_ size_t                   w_, h_;
+    R2Y_ detail_capi_::side_t     in_, ot_;
+};
+
+extern "C" {
+
+R2Y_API int r2y_format_planes(r2y_format fmt, GLB_ size_t w, GLB_ size_t h, GLB_ size_t row_bytes[3], GLB_ size_t rows[3])
+{
+    GLB_ size_t i = R2Y_ detail_capi_::index_of(fmt);
+    if (i >= R2Y_ detail_capi_::formats::size) return R2Y_ERROR_UNSUPPORTED;
+    if ((w == 0) || (h == 0) || (row_bytes == NULL) || (rows == NULL)) return R2Y_ERROR_ARGUMENT;
+    R2Y_ detail_layout_::plane_t planes[3];
+    GLB_ size_t count = R2Y_ detail_capi_::dispatch_t::layout(i)(w, h, planes);
+    for (GLB_ size_t k = 0; k < count; ++k)
+    {
+        row_bytes[k] = planes[k].row_;
+        rows     [k] = planes[k].rows_;
+    }
+    return static_cast<int>(count);
+}
+
+R2Y_API int r2y_plan_create(r2y_format in_fmt, r2y_format ot_fmt, GLB_ size_t w, GLB_ size_t h,
+                            GLB_ size_t const * in_strides, GLB_ size_t const * ot_strides, r2y_plan ** ot_plan)
+{
+    if (ot_plan == NULL) return R2Y_ERROR_ARGUMENT;
+    (*ot_plan) = NULL;
+    GLB_ size_t in_i = R2Y_ detail_capi_::index_of(in_fmt),
+                ot_i = R2Y_ detail_capi_::index_of(ot_fmt);
+    if ((in_i >= R2Y_ detail_capi_::formats::size) || (ot_i >= R2Y_ detail_capi_::formats::size)) return R2Y_ERROR_UNSUPPORTED;
+    if ((w == 0) || (h == 0)) return R2Y_ERROR_ARGUMENT;
+    R2Y_ detail_capi_::convert_fn fn = R2Y_ detail_capi_::dispatch_t::convert(in_i, ot_i);
+    if ((fn == NULL) && (in_i != ot_i)) return R2Y_ERROR_UNSUPPORTED;
+
+    r2y_plan * plan = new (STD_ nothrow) r2y_plan{};
+    if (plan == NULL) return R2Y_ERROR_NO_MEMORY;
+    plan->fn_ = fn;
+    plan->w_  = w;
+    plan->h_  = h;
+    int ret = plan->in_.reset(in_i, w, h, in_strides);
+    if (ret == R2Y_OK)
+        ret = plan->ot_.reset(ot_i, w, h, ot_strides);
+    if (ret != R2Y_OK)
+    {
+        delete plan;
+        return ret;
+    }
+    (*ot_plan) = plan;
+    return R2Y_OK;
+}
+
+R2Y_API int r2y_plan_execute(r2y_plan * plan, void const * const * in_planes, void * const * ot_planes)
+{
+    if ((plan == NULL) || !plan->in_.check(in_planes) || !plan->ot_.check(ot_planes)) return R2Y_ERROR_ARGUMENT;
+    void const * const * ot_p = const_cast<void const * const *>(ot_planes);
+    if (plan->fn_ == NULL)
+    {
+        for (GLB_ size_t i = 0; i < plan->in_.count_; ++i)
+        {
+            R2Y_ detail_layout_::plane_t const & p = plan->in_.planes_[i];
+            R2Y_ repitch(plan->in_.plane(in_planes, i), plan->in_.pitch_[i],
+                         plan->ot_.plane(ot_p, i), plan->ot_.pitch_[i], p.row_, p.rows_);
+        }
+        return R2Y_OK;
+    }
+    plan->fn_(plan->in_.frame(in_planes), plan->w_, plan->h_, plan->ot_.frame(ot_p));
+    return R2Y_OK;
+}
+
+R2Y_API void r2y_plan_destroy(r2y_plan * plan)
+{
+    delete plan;
+}
+
+} // extern "C"
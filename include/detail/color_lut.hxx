@@ -0,0 +1,165 @@
+/*
+    rgb2yuv - Code covered by the MIT License
+    Author: mutouyun (http://orzz.org)
+*/
+
+////////////////////////////////////////////////////////////////
+/// A 3D LUT color transform, with tetrahedral interpolation
+////////////////////////////////////////////////////////////////
+
+class lut3d
+{
+    enum : GLB_ int32_t { ONE = 255 << 8 }; // entries are stored in 8.8 fixed point
+
+    struct axis_t
+    {
+        GLB_ uint16_t index_[256]; // lattice index of the input value
+        GLB_ uint8_t  frac_ [256]; // distance to the next lattice point, in 1/255
+    };
+
+    GLB_ size_t                     n_;
+    R2Y_ scope_block<GLB_ uint16_t> table_; // n^3 * [r, g, b], red changes fastest
+    axis_t                          axis_[3];
+
+    static void build_axis(axis_t & axis, GLB_ size_t n, float d_min, float d_max)
+    {
+        for (GLB_ int32_t i = 0; i < 256; ++i)
+        {
+            float t = ((static_cast<float>(i) / 255.0f) - d_min) / (d_max - d_min);
+            t = (t < 0.0f) ? 0.0f : ((t > 1.0f) ? 1.0f : t);
+            GLB_ int32_t p = static_cast<GLB_ int32_t>(t * static_cast<float>((n - 1) * 255) + 0.5f);
+            GLB_ int32_t k = p / 255;
+            if (k >= static_cast<GLB_ int32_t>(n - 1)) k = static_cast<GLB_ int32_t>(n - 2);
+            axis.index_[i] = static_cast<GLB_ uint16_t>(k);
+            axis.frac_ [i] = static_cast<GLB_ uint8_t >(p - (k * 255));
+        }
+    }
+
+    R2Y_FORCE_INLINE_ GLB_ uint16_t const * at(GLB_ size_t r, GLB_ size_t g, GLB_ size_t b) const
+    {
+        return table_.data() + (((b * n_ + g) * n_ + r) * 3);
+    }
+
+public:
+    lut3d(void) : n_(0) {}
+
+    GLB_ size_t size(void) const { return n_; }
+    bool       empty(void) const { return (n_ < 2); }
+
+    /*
+     * Set the lattice from n^3 [r, g, b] float triples (nominal range [0, 1]),
+     * in .cube order: red changes fastest, then green, then blue.
+     * Returns false and keeps the current LUT if any argument is invalid or out of memory.
+     */
+    bool reset(GLB_ size_t n, float const * rgb,
+               float const (& d_min)[3] = { 0.0f, 0.0f, 0.0f },
+               float const (& d_max)[3] = { 1.0f, 1.0f, 1.0f })
+    {
+        if ((n < 2) || (n > 256) || (rgb == NULL)) return false;
+        for (int c = 0; c < 3; ++c)
+        {
+            if (!(d_max[c] > d_min[c])) return false; // NaN is rejected as well
+        }
+        R2Y_ scope_block<GLB_ uint16_t> table{ n * n * n * 3 };
+        if (table.data() == NULL) return false;
+        for (GLB_ size_t i = 0; i < (n * n * n * 3); ++i)
+        {
+            float v = rgb[i] * static_cast<float>(ONE) + 0.5f;
+            v = (v < 0.0f) ? 0.0f : ((v > static_cast<float>(ONE)) ? static_cast<float>(ONE) : v);
+            table[i] = static_cast<GLB_ uint16_t>(v);
+        }
+        n_ = n;
+        table_.swap(table);
+        for (int c = 0; c < 3; ++c)
+        {
+            build_axis(axis_[c], n, d_min[c], d_max[c]);
+        }
+        return true;
+    }
+
+    /*
+     * Load a LUT_3D .cube file (Adobe Cube LUT Specification 1.0).
+     * See: https://wwwimages2.adobe.com/content/dam/acom/en/products/speedgrade/cc/pdfs/cube-lut-specification-1.0.pdf
+     */
+    bool load(char const * path)
+    {
+        GLB_ FILE * fp = GLB_ fopen(path, "r");
+        if (fp == NULL) return false;
+        char        line[256];
+        GLB_ size_t n = 0, count = 0;
+        float       d_min[3] = { 0.0f, 0.0f, 0.0f }, d_max[3] = { 1.0f, 1.0f, 1.0f };
+        R2Y_ scope_block<float> rgb;
+        bool ok = true;
+        while (ok && (GLB_ fgets(line, sizeof(line), fp) != NULL))
+        {
+            float r, g, b;
+            unsigned long k;
+            if ((line[0] == '#') || (line[0] == '\r') || (line[0] == '\n') ||
+                (GLB_ strncmp(line, "TITLE", 5) == 0))
+                continue;
+            else
+            if (GLB_ sscanf(line, "LUT_3D_SIZE %lu", &k) == 1)
+            {
+                n = static_cast<GLB_ size_t>(k);
+                ok = (n >= 2) && (n <= 256) && (count == 0);
+                if (ok) rgb.reset(n * n * n * 3);
+            }
+            else
+            if (GLB_ sscanf(line, "DOMAIN_MIN %f %f %f", &d_min[0], &d_min[1], &d_min[2]) == 3) continue;
+            else
+            if (GLB_ sscanf(line, "DOMAIN_MAX %f %f %f", &d_max[0], &d_max[1], &d_max[2]) == 3) continue;
+            else
+            if (GLB_ sscanf(line, "%f %f %f", &r, &g, &b) == 3)
+            {
+                ok = (n > 0) && (count < (n * n * n));
+                if (!ok) break;
+                rgb[count * 3    ] = r;
+                rgb[count * 3 + 1] = g;
+                rgb[count * 3 + 2] = b;
+                ++count;
+            }
+            else ok = false; // LUT_1D_SIZE and unknown keywords are not supported
+        }
+        GLB_ fclose(fp);
+        if (!ok || (n == 0) || (count != (n * n * n))) return false;
+        return reset(n, rgb.data(), d_min, d_max);
+    }
+
+    /*
+     * Split the cube into 6 tetrahedra by the order of the fractions,
+     * and mix the 4 vertices of the one containing the input.
+     */
+    R2Y_FORCE_INLINE_ R2Y_ rgb_t apply(R2Y_ rgb_t const & in_p) const
+    {
+        GLB_ size_t  r = axis_[0].index_[in_p.r_], g = axis_[1].index_[in_p.g_], b = axis_[2].index_[in_p.b_];
+        GLB_ int32_t fr = axis_[0].frac_[in_p.r_], fg = axis_[1].frac_[in_p.g_], fb = axis_[2].frac_[in_p.b_];
+        GLB_ uint16_t const * c000 = at(r    , g    , b    );
+        GLB_ uint16_t const * c111 = at(r + 1, g + 1, b + 1);
+        GLB_ uint16_t const * c1, * c2;
+        GLB_ int32_t w0, w1, w2, w3;
+        if (fr >= fg)
+        {
+            if (fg >= fb)      { c1 = at(r + 1, g, b); c2 = at(r + 1, g + 1, b); w0 = 255 - fr; w1 = fr - fg; w2 = fg - fb; w3 = fb; }
+            else if (fr >= fb) { c1 = at(r + 1, g, b); c2 = at(r + 1, g, b + 1); w0 = 255 - fr; w1 = fr - fb; w2 = fb - fg; w3 = fg; }
+            else               { c1 = at(r, g, b + 1); c2 = at(r + 1, g, b + 1); w0 = 255 - fb; w1 = fb - fr; w2 = fr - fg; w3 = fg; }
+        }
+        else
+        {
+            if (fb >= fg)      { c1 = at(r, g, b + 1); c2 = at(r, g + 1, b + 1); w0 = 255 - fb; w1 = fb - fg; w2 = fg - fr; w3 = fr; }
+            else if (fb >= fr) { c1 = at(r, g + 1, b); c2 = at(r, g + 1, b + 1); w0 = 255 - fg; w1 = fg - fb; w2 = fb - fr; w3 = fr; }
+            else               { c1 = at(r, g + 1, b); c2 = at(r + 1, g + 1, b); w0 = 255 - fg; w1 = fg - fr; w2 = fr - fb; w3 = fb; }
+        }
+        // (8.8 * 255) -> 8 bits, rounded
+        enum : GLB_ int32_t { DIV = 255 << 8, HALF = DIV >> 1 };
+        R2Y_ rgb_t ot_p;
+        ot_p.r_ = static_cast<GLB_ uint8_t>( (c000[0] * w0 + c1[0] * w1 + c2[0] * w2 + c111[0] * w3 + HALF) / DIV );
+        ot_p.g_ = static_cast<GLB_ uint8_t>( (c000[1] * w0 + c1[1] * w1 + c2[1] * w2 + c111[1] * w3 + HALF) / DIV );
+        ot_p.b_ = static_cast<GLB_ uint8_t>( (c000[2] * w0 + c1[2] * w1 + c2[2] * w2 + c111[2] * w3 + HALF) / DIV );
+        return ot_p;
+    }
+
+    R2Y_FORCE_INLINE_ R2Y_ rgb_t operator()(R2Y_ rgb_t const & in_p) const
+    {
+        return this->apply(in_p);
+    }
+};
@@ -0,0 +1,249 @@
+/*
+    rgb2yuv - Code covered by the MIT License
+    Author: mutouyun (http://orzz.org)
+*/
+
+////////////////////////////////////////////////////////////////
+/// Converting linear RGB to HDR (BT.2100) YCbCr
+////////////////////////////////////////////////////////////////
+
+enum transfer
+{
+    transfer_NONE, // input is already non-linear (R'G'B')
+    transfer_PQ,   // SMPTE ST 2084, 65535 means 10000 cd/m2
+    transfer_HLG,  // ARIB STD-B67, 65535 means the nominal peak
+    transfer_MAX
+};
+
+namespace detail_hdr_ {
+
+/*
+ * The OETFs, E and E' are both in [0, 1].
+ * See: https://www.itu.int/rec/R-REC-BT.2100
+ */
+
+inline double eotf_pq(double e) // -> [0, 1], 1 means 10000 cd/m2
+{
+    double const m1 = 0.1593017578125, m2 = 78.84375;
+    double const c1 = 0.8359375, c2 = 18.8515625, c3 = 18.6875;
+    double y = GLB_ pow(e, 1.0 / m2);
+    double n = y - c1;
+    return GLB_ pow(((n < 0.0) ? 0.0 : n) / (c2 - c3 * y), 1.0 / m1);
+}
+
+inline double oetf(R2Y_ transfer tf, double e)
+{
+    switch (tf)
+    {
+    case R2Y_ transfer_PQ:
+        {
+            double const m1 = 0.1593017578125, m2 = 78.84375;
+            double const c1 = 0.8359375, c2 = 18.8515625, c3 = 18.6875;
+            double y = GLB_ pow(e, m1);
+            return GLB_ pow((c1 + c2 * y) / (1.0 + c3 * y), m2);
+        }
+    case R2Y_ transfer_HLG:
+        {
+            double const a = 0.17883277, b = 0.28466892, c = 0.55991073;
+            return (e <= (1.0 / 12.0)) ? GLB_ sqrt(3.0 * e) : (a * GLB_ log(12.0 * e - b) + c);
+        }
+    default:
+        return e;
+    }
+}
+
+/*
+ * Tabulate the OETF for all the 16-bit inputs once,
+ * so each channel costs a single lookup.
+ */
+template <R2Y_ transfer TF>
+struct oetf_table
+{
+    GLB_ uint16_t tb_[65536];
+
+    oetf_table(void)
+    {
+        for (GLB_ int32_t i = 0; i < 65536; ++i)
+        {
+            double e = R2Y_ detail_hdr_::oetf(TF, static_cast<double>(i) / 65535.0);
+            tb_[i] = static_cast<GLB_ uint16_t>(e * 65535.0 + 0.5);
+        }
+    }
+};
+
+template <R2Y_ transfer TF>
+GLB_ uint16_t const * oetf_lookup(void)
+{
+    static R2Y_ detail_hdr_::oetf_table<TF> const table;
+    return table.tb_;
+}
+
+} // namespace detail_hdr_
+
+/*
+ * BT.2020 non-constant luminance, 10-bit narrow range:
+ * Y' = 0.2627 R' + 0.6780 G' + 0.0593 B'
+ * Cb = (B' - Y') / 1.8814, Cr = (R' - Y') / 1.4746
+ */
+class hdr_convertor
+{
+    GLB_ uint16_t const * tb_;
+
+public:
+    hdr_convertor(R2Y_ transfer tf)
+        : tb_((tf == R2Y_ transfer_PQ ) ? R2Y_ detail_hdr_::oetf_lookup<R2Y_ transfer_PQ >() :
+              (tf == R2Y_ transfer_HLG) ? R2Y_ detail_hdr_::oetf_lookup<R2Y_ transfer_HLG>() : NULL)
+    {}
+
+    R2Y_FORCE_INLINE_ R2Y_ yuv16_t operator()(R2Y_ rgb16_t const & in_p) const
+    {
+        float r, g, b;
+        if (tb_ == NULL)
+        {
+            r = in_p.r_; g = in_p.g_; b = in_p.b_;
+        }
+        else
+        {
+            r = tb_[in_p.r_]; g = tb_[in_p.g_]; b = tb_[in_p.b_];
+        }
+        float y  = (0.2627f * r) + (0.6780f * g) + (0.0593f * b);
+        float cb = (b - y) * (896.0f / 1.8814f / 65535.0f);
+        float cr = (r - y) * (896.0f / 1.4746f / 65535.0f);
+        y *= (876.0f / 65535.0f);
+        return
+        {
+            static_cast<GLB_ uint16_t>(cr + 512.5f),
+            static_cast<GLB_ uint16_t>(cb + 512.5f),
+            static_cast<GLB_ uint16_t>(y  + 64.5f )
+        };
+    }
+};
+
+////////////////////////////////////////////////////////////////
+/// Tone mapping HDR (BT.2100) YCbCr to SDR RGB
+////////////////////////////////////////////////////////////////
+
+enum tonemap_op
+{
+    tonemap_REINHARD, // extended Reinhard, the source peak maps to the SDR white
+    tonemap_HABLE,    // Hable (Uncharted 2) filmic curve
+    tonemap_BT2390,   // BT.2390 EETF, a hermite knee in the PQ domain
+    tonemap_MAX
+};
+
+struct tone_map
+{
+    R2Y_ transfer   tf_;       // transfer of the source, PQ or HLG
+    R2Y_ tonemap_op op_;
+    float           src_peak_; // cd/m2, mastering peak (PQ) or display peak (HLG)
+    float           dst_peak_; // cd/m2, the SDR white
+};
+
+/*
+ * Per pixel:
+ * 10-bit Y'CbCr -> BT.2020 R'G'B' -> linear light, tone mapped per channel (one lookup)
+ *  -> BT.2020 to BT.709 primaries (3x3 in linear light) -> BT.709 OETF (one lookup) -> 8-bit R'G'B'
+ * Both curves are tabulated on 12-bit inputs when the tone_mapper is created
+ * (the linear segment of the BT.709 OETF keeps the 12-bit steps below one code in the shadows).
+ */
+class tone_mapper
+{
+    enum { LUT_BITS = 12, LUT_MAX = (1 << LUT_BITS) - 1 };
+
+    float         linear_[LUT_MAX + 1]; // R'(BT.2020) -> tone mapped linear light, SDR white is 1
+    GLB_ uint8_t  gamma_ [LUT_MAX + 1]; // linear light -> 8-bit R'(BT.709)
+
+    static double eetf_bt2390(double e, double src_pq, double dst_pq)
+    {
+        double e1 = e / src_pq;
+        double max_lum = dst_pq / src_pq;
+        double ks = 1.5 * max_lum - 0.5;
+        if (e1 > ks)
+        {
+            double t = (e1 - ks) / (1.0 - ks);
+            if (t > 1.0) t = 1.0;
+            double t2 = t * t, t3 = t2 * t;
+            e1 = (2.0 * t3 - 3.0 * t2 + 1.0) * ks + (t3 - 2.0 * t2 + t) * (1.0 - ks) + (-2.0 * t3 + 3.0 * t2) * max_lum;
+        }
+        return e1 * src_pq;
+    }
+
+    static double hable(double x)
+    {
+        double const a = 0.15, b = 0.50, c = 0.10, d = 0.20, e = 0.02, f = 0.30;
+        return ((x * (a * x + c * b) + d * e) / (x * (a * x + b) + d * f)) - e / f;
+    }
+
+    double tone(double nits, R2Y_ tone_map const & tm) const
+    {
+        double w = tm.src_peak_ / tm.dst_peak_; // the source peak, relative to the SDR white
+        double x = nits / tm.dst_peak_;
+        switch (tm.op_)
+        {
+        case R2Y_ tonemap_REINHARD:
+            return x * (1.0 + x / (w * w)) / (1.0 + x);
+        case R2Y_ tonemap_HABLE:
+            return hable(x) / hable(w);
+        case R2Y_ tonemap_BT2390:
+            {
+                double e = R2Y_ detail_hdr_::oetf(R2Y_ transfer_PQ, nits / 10000.0);
+                e = eetf_bt2390(e, R2Y_ detail_hdr_::oetf(R2Y_ transfer_PQ, tm.src_peak_ / 10000.0),
+                                   R2Y_ detail_hdr_::oetf(R2Y_ transfer_PQ, tm.dst_peak_ / 10000.0));
+                return R2Y_ detail_hdr_::eotf_pq(e) * 10000.0 / tm.dst_peak_;
+            }
+        default:
+            return x;
+        }
+    }
+
+    R2Y_FORCE_INLINE_ static GLB_ int32_t index(float v)
+    {
+        GLB_ int32_t i = static_cast<GLB_ int32_t>(v * static_cast<float>(LUT_MAX) + 0.5f);
+        return (i < 0) ? 0 : ((i > LUT_MAX) ? LUT_MAX : i);
+    }
+
+public:
+    tone_mapper(R2Y_ tone_map const & tm)
+    {
+        assert(tm.tf_ == R2Y_ transfer_PQ || tm.tf_ == R2Y_ transfer_HLG);
+        assert(tm.src_peak_ > tm.dst_peak_ && tm.dst_peak_ > 0.0f);
+        for (GLB_ int32_t i = 0; i <= LUT_MAX; ++i)
+        {
+            double e = static_cast<double>(i) / LUT_MAX, nits;
+            if (tm.tf_ == R2Y_ transfer_PQ)
+            {
+                nits = R2Y_ detail_hdr_::eotf_pq(e) * 10000.0;
+            }
+            else
+            {
+                // HLG inverse OETF, then the OOTF (gamma 1.2) applied on each channel
+                double const a = 0.17883277, b = 0.28466892, c = 0.55991073;
+                double s = (e <= 0.5) ? (e * e / 3.0) : ((GLB_ exp((e - c) / a) + b) / 12.0);
+                nits = tm.src_peak_ * GLB_ pow(s, 1.2);
+            }
+            double l = tone(nits, tm);
+            linear_[i] = static_cast<float>((l < 0.0) ? 0.0 : l);
+            double v = (e < 0.018) ? (4.5 * e) : (1.099 * GLB_ pow(e, 0.45) - 0.099);
+            gamma_ [i] = static_cast<GLB_ uint8_t>(v * 255.0 + 0.5);
+        }
+    }
+
+    R2Y_FORCE_INLINE_ R2Y_ rgb_t operator()(R2Y_ yuv16_t const & in_p) const
+    {
+        // 10-bit narrow range BT.2020 -> R'G'B'
+        float y  = (static_cast<float>(in_p.y_) - 64.0f ) / 876.0f;
+        float cb = (static_cast<float>(in_p.u_) - 512.0f) / 896.0f;
+        float cr = (static_cast<float>(in_p.v_) - 512.0f) / 896.0f;
+        float r_ = y + 1.4746f * cr;
+        float b_ = y + 1.8814f * cb;
+        float g_ = (y - 0.2627f * r_ - 0.0593f * b_) / 0.6780f;
+        // Tone mapped linear light
+        float r = linear_[index(r_)], g = linear_[index(g_)], b = linear_[index(b_)];
+        // BT.2020 -> BT.709 primaries
+        R2Y_ rgb_t ot_p;
+        ot_p.r_ = gamma_[index( 1.6605f * r - 0.5876f * g - 0.0728f * b)];
+        ot_p.g_ = gamma_[index(-0.1246f * r + 1.1329f * g - 0.0083f * b)];
+        ot_p.b_ = gamma_[index(-0.0182f * r - 0.1006f * g + 1.1187f * b)];
+        return ot_p;
+    }
+};
@@ -0,0 +1,143 @@
+/*
+    rgb2yuv - Code covered by the MIT License
+    Author: mutouyun (http://orzz.org)
+*/
+
+////////////////////////////////////////////////////////////////
+/// Checksums of the output planes, computed while converting
+////////////////////////////////////////////////////////////////
+
+/*
+ * The CRC32C (Castagnoli) of each plane of a frame, in memory order,
+ * e.g. NV12: Y, CbCr; YV12: Y, Cr, Cb; packed and block ordered formats are a single plane.
+ */
+struct checksum
+{
+    GLB_ uint32_t crc_[3];
+    GLB_ size_t   count_;
+};
+
+namespace detail_checksum_ {
+
+/* CRC32C, with the SSE 4.2/ARMv8 CRC instructions when the target has them */
+
+#if !defined(__SSE4_2__) && !defined(__ARM_FEATURE_CRC32)
+struct crc32c_table
+{
+    GLB_ uint32_t t_[8][256]; // slicing by 8
+
+    crc32c_table(void)
+    {
+        for (GLB_ uint32_t i = 0; i < 256; ++i)
+        {
+            GLB_ uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c >> 1) ^ (0x82F63B78u & (0u - (c & 1)));
+            t_[0][i] = c;
+        }
+        for (GLB_ uint32_t i = 0; i < 256; ++i)
+        {
+            for (int k = 1; k < 8; ++k) t_[k][i] = (t_[k - 1][i] >> 8) ^ t_[0][t_[k - 1][i] & 0xFF];
+        }
+    }
+
+    static crc32c_table const & instance(void)
+    {
+        static crc32c_table const table;
+        return table;
+    }
+};
+#endif
+
+/* Continue a CRC32C over [in_p, in_p + in_n), crc starts from (and ends with) ~0 inverted */
+inline GLB_ uint32_t crc32c(GLB_ uint32_t crc, R2Y_ byte_t const * in_p, GLB_ size_t in_n)
+{
+#if defined(__SSE4_2__) && (defined(__x86_64__) || defined(_M_X64))
+    GLB_ uint64_t c = crc;
+    for (; in_n >= 8; in_n -= 8, in_p += 8)
+    {
+        GLB_ uint64_t v;
+        memcpy(&v, in_p, sizeof(v));
+        c = _mm_crc32_u64(c, v);
+    }
+    crc = static_cast<GLB_ uint32_t>(c);
+    for (; in_n > 0; --in_n, ++in_p) crc = _mm_crc32_u8(crc, *in_p);
+#elif defined(__SSE4_2__)
+    for (; in_n >= 4; in_n -= 4, in_p += 4)
+    {
+        GLB_ uint32_t v;
+        memcpy(&v, in_p, sizeof(v));
+        crc = _mm_crc32_u32(crc, v);
+    }
+    for (; in_n > 0; --in_n, ++in_p) crc = _mm_crc32_u8(crc, *in_p);
+#elif defined(__ARM_FEATURE_CRC32)
+    for (; in_n >= 8; in_n -= 8, in_p += 8)
+    {
+        GLB_ uint64_t v;
+        memcpy(&v, in_p, sizeof(v));
+        crc = __crc32cd(crc, v);
+    }
+    for (; in_n > 0; --in_n, ++in_p) crc = __crc32cb(crc, *in_p);
+#else
+    GLB_ uint32_t const (& t)[8][256] = R2Y_ detail_checksum_::crc32c_table::instance().t_;
+    for (; in_n >= 8; in_n -= 8, in_p += 8)
+    {
+        GLB_ uint32_t lo = crc ^ ( static_cast<GLB_ uint32_t>(in_p[0])        | (static_cast<GLB_ uint32_t>(in_p[1]) << 8) |
+                                  (static_cast<GLB_ uint32_t>(in_p[2]) << 16) | (static_cast<GLB_ uint32_t>(in_p[3]) << 24) );
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][in_p[4]]   ^ t[2][in_p[5]]          ^ t[1][in_p[6]]           ^ t[0][in_p[7]];
+    }
+    for (; in_n > 0; --in_n, ++in_p) crc = t[0][(crc ^ (*in_p)) & 0xFF] ^ (crc >> 8);
+#endif
+    return crc;
+}
+
+/*
+ * Hash the planes of a frame band by band, as the rows are finished,
+ * so each row is hashed while it is still in the cache.
+ */
+template <R2Y_ supported S>
+class plane_hasher
+{
+    R2Y_ byte_t const *            data_;
+    R2Y_ detail_layout_::plane_t planes_[3];
+    GLB_ size_t                    count_;
+    GLB_ uint32_t                  crc_[3];
+    GLB_ size_t                    done_[3]; // the rows hashed of each plane
+
+public:
+    plane_hasher(R2Y_ byte_t const * ot_data, GLB_ size_t in_w, GLB_ size_t in_h)
+        : data_(ot_data), count_(R2Y_ detail_layout_::layout<S>(in_w, in_h, planes_))
+    {
+        for (GLB_ size_t i = 0; i < count_; ++i)
+        {
+            crc_[i]  = ~0u;
+            done_[i] = 0;
+        }
+    }
+
+    /* The image rows [0, in_y) are written */
+    void rows_done(GLB_ size_t in_y)
+    {
+        for (GLB_ size_t i = 0; i < count_; ++i)
+        {
+            R2Y_ detail_layout_::plane_t const & p = planes_[i];
+            GLB_ size_t rows = (in_y + p.sub_y_ - 1) / p.sub_y_;
+            if (rows > p.rows_) rows = p.rows_;
+            if (rows <= done_[i]) continue;
+            crc_[i] = R2Y_ detail_checksum_::crc32c(crc_[i], data_ + p.offset_ + (done_[i] * p.row_), (rows - done_[i]) * p.row_);
+            done_[i] = rows;
+        }
+    }
+
+    void result(R2Y_ checksum & ot_sums) const
+    {
+        for (GLB_ size_t i = 0; i < count_; ++i)
+        {
+            assert(done_[i] == planes_[i].rows_);
+            ot_sums.crc_[i] = ~crc_[i];
+        }
+        ot_sums.count_ = count_;
+    }
+};
+
+} // namespace detail_checksum_
@@ -59,7 +59,7 @@ private:
     GLB_ int32_t tb_[3][convertor::MAX + 1];
 };
 
-R2Y_FORCE_INLINE_ convertor const * factor_matrix(void)
+R2Y_FORCE_INLINE_ auto factors(void) -> GLB_ int32_t const (&)[R2Y_ plane_MAX][4]
 {
     /*
      * The factors for converting between YUV and RGB
@@ -75,6 +75,12 @@ R2Y_FORCE_INLINE_ convertor const * factor_matrix(void)
         {  298, -100, -208,  34784 },  // YUV -> G
         {  298,  516,  0  , -70688 }   // YUV -> B
     };
+    return matrix;
+}
+
+R2Y_FORCE_INLINE_ convertor const * factor_matrix(void)
+{
+    GLB_ int32_t const (& matrix)[R2Y_ plane_MAX][4] = R2Y_ factors();
     // Create and initialize the convertors
     static R2Y_ convertor const conv[R2Y_ plane_MAX] =
     {
@@ -118,3 +124,218 @@ R2Y_FORCE_INLINE_ R2Y_ rgb_t pixel_convert(R2Y_ yuv_t const & in_p)
         pixel_convert<R2Y_ plane_R>(in_p)
     };
 }
+
+/*
+ * Converting arrays of pixels (e.g. point clouds, palettes) and planar rows, 16 pixels a step with SSE2/NEON,
+ * with the same integer factors as the tables, so the results are the same as pixel_convert of each pixel.
+ */
+
+namespace detail_convertor_ {
+
+/* 16 samples of a plane (bytes, or the 16-bit lanes of planar rows) as two halves of 8 x int16 */
+
+#if defined(__SSE2__) || defined(_M_X64)
+R2Y_FORCE_INLINE_ void load16(R2Y_ byte_t const * in_p, __m128i (& ot_h)[2])
+{
+    __m128i x = _mm_loadu_si128(reinterpret_cast<__m128i const *>(in_p));
+    ot_h[0] = _mm_unpacklo_epi8(x, _mm_setzero_si128());
+    ot_h[1] = _mm_unpackhi_epi8(x, _mm_setzero_si128());
+}
+
+R2Y_FORCE_INLINE_ void load16(GLB_ int16_t const * in_p, __m128i (& ot_h)[2])
+{
+    ot_h[0] = _mm_loadu_si128(reinterpret_cast<__m128i const *>(in_p));
+    ot_h[1] = _mm_loadu_si128(reinterpret_cast<__m128i const *>(in_p + 8));
+}
+
+R2Y_FORCE_INLINE_ void store16(R2Y_ byte_t * ot_p, __m128i const (& in_h)[2])
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(ot_p), _mm_packus_epi16(in_h[0], in_h[1]));
+}
+
+R2Y_FORCE_INLINE_ void store16(GLB_ int16_t * ot_p, __m128i const (& in_h)[2])
+{
+    __m128i const zero = _mm_setzero_si128(), max = _mm_set1_epi16(R2Y_ convertor::MAX);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(ot_p    ), _mm_min_epi16(_mm_max_epi16(in_h[0], zero), max));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(ot_p + 8), _mm_min_epi16(_mm_max_epi16(in_h[1], zero), max));
+}
+#elif defined(__ARM_NEON)
+R2Y_FORCE_INLINE_ void load16(R2Y_ byte_t const * in_p, int16x8_t (& ot_h)[2])
+{
+    uint8x16_t x = vld1q_u8(in_p);
+    ot_h[0] = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8 (x)));
+    ot_h[1] = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(x)));
+}
+
+R2Y_FORCE_INLINE_ void load16(GLB_ int16_t const * in_p, int16x8_t (& ot_h)[2])
+{
+    ot_h[0] = vld1q_s16(in_p);
+    ot_h[1] = vld1q_s16(in_p + 8);
+}
+
+R2Y_FORCE_INLINE_ void store16(R2Y_ byte_t * ot_p, int16x8_t const (& in_h)[2])
+{
+    vst1q_u8(ot_p, vcombine_u8(vqmovun_s16(in_h[0]), vqmovun_s16(in_h[1])));
+}
+
+R2Y_FORCE_INLINE_ void store16(GLB_ int16_t * ot_p, int16x8_t const (& in_h)[2])
+{
+    int16x8_t const zero = vdupq_n_s16(0), max = vdupq_n_s16(R2Y_ convertor::MAX);
+    vst1q_s16(ot_p,     vminq_s16(vmaxq_s16(in_h[0], zero), max));
+    vst1q_s16(ot_p + 8, vminq_s16(vmaxq_s16(in_h[1], zero), max));
+}
+#endif
+
+/*
+ * ot[i] = (m[0] * in_a[i] + m[1] * in_b[i] + m[2] * in_c[i] + m[3]) >> 8, in [0, 255],
+ * T is R2Y_ byte_t for planes of bytes, or GLB_ int16_t for the lanes of planar rows (in [0, 255] as well).
+ */
+template <R2Y_ plane_type P, typename T>
+void convert_plane(T const * in_a, T const * in_b, T const * in_c, T * ot_data, GLB_ size_t in_n)
+{
+    GLB_ int32_t const (& m)[4] = R2Y_ factors()[P];
+    GLB_ size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const m_ab = _mm_set1_epi32(static_cast<int>((static_cast<GLB_ uint32_t>(m[0]) & 0xFFFF) |
+                                                        (static_cast<GLB_ uint32_t>(m[1]) << 16))); // (a, b) pairs
+    __m128i const m_c0 = _mm_set1_epi32( m[2] & 0xFFFF);                  // (c, 0) pairs
+    __m128i const m_d  = _mm_set1_epi32( m[3]);
+    for (; (i + 16) <= in_n; i += 16)
+    {
+        __m128i a[2], b[2], c[2], r[2];
+        R2Y_ detail_convertor_::load16(in_a + i, a);
+        R2Y_ detail_convertor_::load16(in_b + i, b);
+        R2Y_ detail_convertor_::load16(in_c + i, c);
+        for (int h = 0; h < 2; ++h)
+        {
+            __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(a[h], b[h]), m_ab),
+                                       _mm_madd_epi16(_mm_unpacklo_epi16(c[h], zero), m_c0));
+            __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(a[h], b[h]), m_ab),
+                                       _mm_madd_epi16(_mm_unpackhi_epi16(c[h], zero), m_c0));
+            r[h] = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(lo, m_d), 8),
+                                   _mm_srai_epi32(_mm_add_epi32(hi, m_d), 8));
+        }
+        R2Y_ detail_convertor_::store16(ot_data + i, r);
+    }
+#elif defined(__ARM_NEON)
+    int32x4_t const m_d = vdupq_n_s32(m[3]);
+    for (; (i + 16) <= in_n; i += 16)
+    {
+        int16x8_t a[2], b[2], c[2], r[2];
+        R2Y_ detail_convertor_::load16(in_a + i, a);
+        R2Y_ detail_convertor_::load16(in_b + i, b);
+        R2Y_ detail_convertor_::load16(in_c + i, c);
+        for (int h = 0; h < 2; ++h)
+        {
+            int32x4_t lo = vmlaq_n_s32(m_d, vmovl_s16(vget_low_s16 (a[h])), m[0]);
+            int32x4_t hi = vmlaq_n_s32(m_d, vmovl_s16(vget_high_s16(a[h])), m[0]);
+            lo = vmlaq_n_s32(lo, vmovl_s16(vget_low_s16 (b[h])), m[1]);
+            hi = vmlaq_n_s32(hi, vmovl_s16(vget_high_s16(b[h])), m[1]);
+            lo = vmlaq_n_s32(lo, vmovl_s16(vget_low_s16 (c[h])), m[2]);
+            hi = vmlaq_n_s32(hi, vmovl_s16(vget_high_s16(c[h])), m[2]);
+            r[h] = vcombine_s16(vqmovn_s32(vshrq_n_s32(lo, 8)), vqmovn_s32(vshrq_n_s32(hi, 8)));
+        }
+        R2Y_ detail_convertor_::store16(ot_data + i, r);
+    }
+#endif
+    for (; i < in_n; ++i)
+    {
+        ot_data[i] = static_cast<T>(R2Y_ convertor::clip(((m[0] * in_a[i]) + (m[1] * in_b[i]) + (m[2] * in_c[i]) + m[3]) >> 8));
+    }
+}
+
+} // namespace detail_convertor_
+
+/*
+ * Convert in_n pixels given as planes into the plane P,
+ * the inputs are R, G, B for a YUV plane, and Y, U, V for a RGB plane.
+ */
+template <R2Y_ plane_type P>
+void pixel_convert(R2Y_ byte_t const * in_0, R2Y_ byte_t const * in_1, R2Y_ byte_t const * in_2,
+                   R2Y_ byte_t * ot_data, GLB_ size_t in_n)
+{
+    assert((in_n == 0) || (in_0 != NULL && in_1 != NULL && in_2 != NULL && ot_data != NULL));
+    R2Y_ detail_convertor_::convert_plane<P>(in_0, in_1, in_2, ot_data, in_n);
+}
+
+namespace detail_convertor_ {
+
+/* Split the pixels into planes on the stack, convert them, and put the results back */
+template <R2Y_ plane_type P0, typename In, typename Ot>
+void convert_pixels(In const * in_p, Ot * ot_p, GLB_ size_t in_n)
+{
+    enum : GLB_ size_t { chunk = 256 };
+    R2Y_ byte_t in_c[3][chunk], ot_c[3][chunk];
+    while (in_n > 0)
+    {
+        GLB_ size_t n = (in_n < chunk) ? in_n : chunk;
+        for (GLB_ size_t i = 0; i < n; ++i)
+        {
+            R2Y_ pixel_t const & p = R2Y_ pixel_t::cast(in_p[i]);
+            in_c[0][i] = p.a_;
+            in_c[1][i] = p.b_;
+            in_c[2][i] = p.c_;
+        }
+        R2Y_ pixel_convert<static_cast<R2Y_ plane_type>(P0    )>(in_c[0], in_c[1], in_c[2], ot_c[0], n);
+        R2Y_ pixel_convert<static_cast<R2Y_ plane_type>(P0 + 1)>(in_c[0], in_c[1], in_c[2], ot_c[1], n);
+        R2Y_ pixel_convert<static_cast<R2Y_ plane_type>(P0 + 2)>(in_c[0], in_c[1], in_c[2], ot_c[2], n);
+        for (GLB_ size_t i = 0; i < n; ++i)
+        {
+            R2Y_ byte_t * p = reinterpret_cast<R2Y_ byte_t *>(ot_p + i);
+            p[2] = ot_c[0][i]; // Y, R
+            p[1] = ot_c[1][i]; // U, G
+            p[0] = ot_c[2][i]; // V, B
+        }
+        in_p += n;
+        ot_p += n;
+        in_n -= n;
+    }
+}
+
+} // namespace detail_convertor_
+
+/* Convert an array of pixels: ot_p[i] = pixel_convert(in_p[i]) */
+
+inline void pixel_convert(R2Y_ rgb_t const * in_p, R2Y_ yuv_t * ot_p, GLB_ size_t in_n)
+{
+    assert((in_n == 0) || (in_p != NULL && ot_p != NULL));
+    R2Y_ detail_convertor_::convert_pixels<R2Y_ plane_Y>(in_p, ot_p, in_n);
+}
+
+inline void pixel_convert(R2Y_ yuv_t const * in_p, R2Y_ rgb_t * ot_p, GLB_ size_t in_n)
+{
+    assert((in_n == 0) || (in_p != NULL && ot_p != NULL));
+    R2Y_ detail_convertor_::convert_pixels<R2Y_ plane_R>(in_p, ot_p, in_n);
+}
+
+namespace detail_convertor_ {
+
+/* Convert planar rows into the planes P0, P0 + 1, P0 + 2 (Y/U/V or R/G/B), a lane at a time with convert_plane */
+template <R2Y_ plane_type P0, typename In, typename Ot, int R, GLB_ size_t N>
+void convert_rows(R2Y_ detail_rows_::planar_rows<In, R, N> const & in_rows,
+                  R2Y_ detail_rows_::planar_rows<Ot, R, N>       & ot_rows, GLB_ size_t in_n)
+{
+    for (int r = 0; r < R; ++r)
+    {
+        convert_plane<static_cast<R2Y_ plane_type>(P0    )>(in_rows.a_[r], in_rows.b_[r], in_rows.c_[r], ot_rows.a_[r], in_n);
+        convert_plane<static_cast<R2Y_ plane_type>(P0 + 1)>(in_rows.a_[r], in_rows.b_[r], in_rows.c_[r], ot_rows.b_[r], in_n);
+        convert_plane<static_cast<R2Y_ plane_type>(P0 + 2)>(in_rows.a_[r], in_rows.b_[r], in_rows.c_[r], ot_rows.c_[r], in_n);
+    }
+}
+
+} // namespace detail_convertor_
+
+template <int R, GLB_ size_t N>
+void pixel_convert(R2Y_ detail_rows_::planar_rows<R2Y_ rgb_t, R, N> const & in_rows,
+                   R2Y_ detail_rows_::planar_rows<R2Y_ yuv_t, R, N>       & ot_rows, GLB_ size_t in_n)
+{
+    R2Y_ detail_convertor_::convert_rows<R2Y_ plane_Y>(in_rows, ot_rows, in_n);
+}
+
+template <int R, GLB_ size_t N>
+void pixel_convert(R2Y_ detail_rows_::planar_rows<R2Y_ yuv_t, R, N> const & in_rows,
+                   R2Y_ detail_rows_::planar_rows<R2Y_ rgb_t, R, N>       & ot_rows, GLB_ size_t in_n)
+{
+    R2Y_ detail_convertor_::convert_rows<R2Y_ plane_R>(in_rows, ot_rows, in_n);
+}
@@ -30,30 +30,93 @@ namespace detail_iterator_ {
 template <R2Y_ supported T, R2Y_ supported S = T>
 class impl_;
 
+/*
+ * A pointer walking the rows of a plane in order: in_w elements a row, in_pitch bytes from a row to the next.
+ * A step never crosses the end of a row (the walkers cut their runs there),
+ * and the pointer stays at the end of the last row.
+ */
+template <typename T>
+class row_cursor
+{
+    T *         p_, * e_; // the current element, and the end of its row
+    GLB_ size_t w_, h_, pitch_, row_;
+
+public:
+    row_cursor(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, GLB_ size_t in_pitch)
+        : p_(reinterpret_cast<T *>(in_data)), e_(p_ + in_w), w_(in_w), h_(in_h), pitch_(in_pitch), row_(0)
+    {}
+
+    R2Y_FORCE_INLINE_ T *        get (void) const { return p_; }
+    R2Y_FORCE_INLINE_ GLB_ size_t room(void) const { return static_cast<GLB_ size_t>(e_ - p_); }
+    R2Y_FORCE_INLINE_ GLB_ size_t row (void) const { return row_; }
+
+    /* Move n elements on, returns true when it goes on to the next row */
+    R2Y_FORCE_INLINE_ bool next(GLB_ size_t n)
+    {
+        p_ += n;
+        if ((p_ != e_) || ((row_ + 1) >= h_)) return false;
+        p_ = reinterpret_cast<T *>(reinterpret_cast<R2Y_ byte_t *>(e_ - w_) + pitch_);
+        e_ = p_ + w_;
+        ++row_;
+        return true;
+    }
+};
+
 /* RGB 888 */
 
 template <R2Y_ supported S> class impl_<R2Y_ rgb_888, S>
 {
-    R2Y_ rgb_t * rgb_;
+    R2Y_ detail_iterator_::row_cursor<R2Y_ rgb_t> rgb_;
 
 public:
     enum { iterator_size = 1, is_block = 0 };
 
-    impl_(R2Y_ byte_t * in_data, GLB_ size_t /*in_w*/, GLB_ size_t /*in_h*/)
-        : rgb_(reinterpret_cast<R2Y_ rgb_t *>(in_data))
+    impl_(R2Y_ frame_planes const & in_f, GLB_ size_t in_w, GLB_ size_t in_h)
+        : rgb_(in_f.data_[0], in_w, in_h, in_f.pitch_[0])
+    {}
+
+    impl_(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h)
+        : rgb_(in_data, in_w, in_h, in_w * sizeof(R2Y_ rgb_t))
     {}
 
     void set_and_next(R2Y_ rgb_t const & rhs)
     {
-        (*rgb_) = rhs;
-        ++rgb_;
+        (*rgb_.get()) = rhs;
+        rgb_.next(1);
     }
 
     template <GLB_ size_t N>
     void set_and_next(R2Y_ rgb_t const (&rhs)[N])
     {
-        memcpy(rgb_, rhs, sizeof(rhs));
-        rgb_ += N;
+        memcpy(rgb_.get(), rhs, sizeof(rhs));
+        rgb_.next(N);
+    }
+
+    template <GLB_ size_t N>
+    void set_rows(R2Y_ detail_rows_::planar_rows<R2Y_ rgb_t, 1, N> const & rhs, GLB_ size_t n)
+    {
+        R2Y_ rgb_t * rgb = rgb_.get();
+        for (GLB_ size_t i = 0; i < n; ++i)
+        {
+            rgb[i].b_ = static_cast<GLB_ uint8_t>(rhs.c_[0][i]);
+            rgb[i].g_ = static_cast<GLB_ uint8_t>(rhs.b_[0][i]);
+            rgb[i].r_ = static_cast<GLB_ uint8_t>(rhs.a_[0][i]);
+        }
+        rgb_.next(n);
+    }
+
+    void blend_and_next(R2Y_ rgb_t const & rhs, R2Y_ byte_t a)
+    {
+        R2Y_ rgb_t & pix = *rgb_.get();
+        pix.b_ = R2Y_ detail_mask_::mix(pix.b_, rhs.b_, a);
+        pix.g_ = R2Y_ detail_mask_::mix(pix.g_, rhs.g_, a);
+        pix.r_ = R2Y_ detail_mask_::mix(pix.r_, rhs.r_, a);
+        rgb_.next(1);
+    }
+
+    void skip(GLB_ size_t n)
+    {
+        rgb_.next(n);
     }
 };
 
@@ -61,19 +124,24 @@ public:
 
 template <R2Y_ supported S> class impl_<R2Y_ rgb_888X, S>
 {
-    GLB_ uint32_t * rgb_;
+    R2Y_ detail_iterator_::row_cursor<GLB_ uint32_t> rgb_;
 
 public:
     enum { iterator_size = 1, is_block = 0 };
 
-    impl_(R2Y_ byte_t * in_data, GLB_ size_t /*in_w*/, GLB_ size_t /*in_h*/)
-        : rgb_(reinterpret_cast<GLB_ uint32_t *>(in_data))
+    impl_(R2Y_ frame_planes const & in_f, GLB_ size_t in_w, GLB_ size_t in_h)
+        : rgb_(in_f.data_[0], in_w, in_h, in_f.pitch_[0])
+    {}
+
+    impl_(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h)
+        : rgb_(in_data, in_w, in_h, in_w * sizeof(GLB_ uint32_t))
     {}
 
+    /* The X bytes are left as they are */
     void set_and_next(R2Y_ rgb_t const & rhs)
     {
-        (*reinterpret_cast<R2Y_ rgb_t *>(rgb_)) = rhs;
-        ++rgb_;
+        (*reinterpret_cast<R2Y_ rgb_t *>(rgb_.get())) = rhs;
+        rgb_.next(1);
     }
 
     template <GLB_ size_t N>
@@ -84,6 +152,36 @@ public:
             set_and_next(rhs[i]);
         }
     }
+
+    template <GLB_ size_t N>
+    void set_rows(R2Y_ detail_rows_::planar_rows<R2Y_ rgb_t, 1, N> const & rhs, GLB_ size_t n)
+    {
+        GLB_ uint32_t * rgb = rgb_.get();
+        for (GLB_ size_t i = 0; i < n; ++i)
+        {
+            R2Y_ byte_t pix[sizeof(GLB_ uint32_t)];
+            memcpy(pix, rgb + i, sizeof(pix));
+            pix[0] = static_cast<GLB_ uint8_t>(rhs.c_[0][i]);
+            pix[1] = static_cast<GLB_ uint8_t>(rhs.b_[0][i]);
+            pix[2] = static_cast<GLB_ uint8_t>(rhs.a_[0][i]);
+            memcpy(rgb + i, pix, sizeof(pix));
+        }
+        rgb_.next(n);
+    }
+
+    void blend_and_next(R2Y_ rgb_t const & rhs, R2Y_ byte_t a)
+    {
+        R2Y_ rgb_t & pix = *reinterpret_cast<R2Y_ rgb_t *>(rgb_.get());
+        pix.b_ = R2Y_ detail_mask_::mix(pix.b_, rhs.b_, a);
+        pix.g_ = R2Y_ detail_mask_::mix(pix.g_, rhs.g_, a);
+        pix.r_ = R2Y_ detail_mask_::mix(pix.r_, rhs.r_, a);
+        rgb_.next(1);
+    }
+
+    void skip(GLB_ size_t n)
+    {
+        rgb_.next(n);
+    }
 };
 
 /* YUV Packed */
@@ -105,21 +203,26 @@ template <R2Y_ supported S> class impl_<R2Y_ yuv_YUY2, S>
 {
     typedef R2Y_HELPER_ packed_yuv_t<S> p_t;
 
-    p_t * yuv_;
+    R2Y_ detail_iterator_::row_cursor<p_t> row_; // (w + 1) / 2 macro pixels a row
 
 public:
     enum { iterator_size = 2, is_block = 0 };
 
-    impl_(R2Y_ byte_t * in_data, GLB_ size_t /*in_w*/, GLB_ size_t /*in_h*/)
-        : yuv_(reinterpret_cast<p_t *>(in_data))
+    impl_(R2Y_ frame_planes const & in_f, GLB_ size_t in_w, GLB_ size_t in_h)
+        : row_(in_f.data_[0], (in_w + 1) >> 1, in_h, in_f.pitch_[0])
+    {}
+
+    impl_(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h)
+        : row_(in_data, (in_w + 1) >> 1, in_h, ((in_w + 1) >> 1) * sizeof(p_t))
     {}
 
     void set_and_next(R2Y_ yuv_t const (& rhs)[iterator_size])
     {
+        p_t * yuv_ = row_.get();
         GLB_ uint16_t u_k, v_k;
         R2Y_SET_AND_NEXT_(0, = );
         R2Y_SET_AND_NEXT_(1, +=, yuv_->cb_ = u_k >> 1; yuv_->cr_ = v_k >> 1;);
-        ++yuv_;
+        row_.next(1);
     }
 };
 
@@ -185,27 +288,156 @@ public:
 
 /* YUV Planar */
 
+/*
+ * The luma rows of an N x N block walk.
+ * A partial block on the right edge writes only the columns inside the row,
+ * and the rows below the bottom edge alias the last row, which gets the same (replicated) values.
+ */
+template <typename T, int N>
+class luma_rows
+{
+    T *           y_[N];
+    T *           ye_;  // the end of the first row
+    R2Y_ byte_t * base_;
+    GLB_ size_t   w_, h_, pitch_, row_;
+
+    void rows_at(GLB_ size_t row)
+    {
+        row_ = row;
+        for (int n = 0; n < N; ++n)
+        {
+            GLB_ size_t k = row + n;
+            y_[n] = reinterpret_cast<T *>(base_ + (((k < h_) ? k : (h_ - 1)) * pitch_));
+        }
+        ye_ = y_[0] + w_;
+    }
+
+    /* Go on to the next rows at the end of these, returns true if so */
+    bool next_rows(void)
+    {
+        if (y_[0] != ye_) return false;
+        rows_at(row_ + N);
+        return true;
+    }
+
+public:
+    /* in_pitch: the bytes from a row to the next */
+    luma_rows(T * in_data, GLB_ size_t in_w, GLB_ size_t in_h, GLB_ size_t in_pitch)
+        : base_(reinterpret_cast<R2Y_ byte_t *>(in_data)), w_(in_w), h_(in_h), pitch_(in_pitch)
+    {
+        rows_at(0);
+    }
+
+    T * row(int n) const { return y_[n]; }
+
+    R2Y_FORCE_INLINE_ bool set_and_next(T const (& v)[N * N])
+    {
+        if ((y_[0] + N) <= ye_)
+        {
+            for (int n = 0; n < N; ++n)
+            {
+                for (int m = 0; m < N; ++m) y_[n][m] = v[(n * N) + m];
+                y_[n] += N;
+            }
+        }
+        else
+        {
+            GLB_ size_t c = static_cast<GLB_ size_t>(ye_ - y_[0]);
+            for (int n = 0; n < N; ++n)
+            {
+                for (GLB_ size_t m = 0; m < c; ++m) y_[n][m] = v[(n * N) + m];
+                y_[n] += c;
+            }
+        }
+        return next_rows();
+    }
+
+    /* c columns of the N rows, whole blocks except at the end of the rows */
+    template <GLB_ size_t M>
+    R2Y_FORCE_INLINE_ bool set_rows(GLB_ int16_t const (& v)[N][M], GLB_ size_t c)
+    {
+        GLB_ size_t room = static_cast<GLB_ size_t>(ye_ - y_[0]);
+        if (c > room) c = room;
+        for (int n = 0; n < N; ++n)
+        {
+            for (GLB_ size_t m = 0; m < c; ++m) y_[n][m] = static_cast<T>(v[n][m]);
+            y_[n] += c;
+        }
+        return next_rows();
+    }
+
+    /* n whole blocks on the same rows */
+    bool skip(GLB_ size_t n)
+    {
+        for (int k = 0; k < N; ++k) y_[k] += (n * N);
+        return next_rows();
+    }
+};
+
 /* 4:4:4 */
 
-template <R2Y_ supported S> class impl_<R2Y_ yuv_NV24, S> : R2Y_HELPER_ yuv_planar<S>
+template <R2Y_ supported S> class impl_<R2Y_ yuv_NV24, S>
 {
     typedef R2Y_HELPER_ planar_uv_t<S> uv_t;
 
-    R2Y_ byte_t * y_;
-    uv_t          uv_;
+    R2Y_ frame_planes                              f_;
+    R2Y_ detail_iterator_::row_cursor<R2Y_ byte_t> y_;
+    uv_t                                           uv_;
+
+    /* The luma is n pixels on, the chroma follows it to the next row */
+    void next(GLB_ size_t n)
+    {
+        if (y_.next(n)) uv_ = R2Y_HELPER_ planar_uv_at<S>(f_, y_.row());
+    }
 
 public:
     enum { iterator_size = 1, is_block = 0 };
 
+    impl_(R2Y_ frame_planes const & in_f, GLB_ size_t in_w, GLB_ size_t in_h)
+        : f_(in_f), y_(in_f.data_[0], in_w, in_h, in_f.pitch_[0]), uv_(R2Y_HELPER_ planar_uv_at<S>(in_f, 0))
+    {}
+
     impl_(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h)
-        : R2Y_HELPER_ yuv_planar<S>(y_, uv_, in_data, in_w, in_h)
+        : impl_(R2Y_ detail_layout_::tight_planes<S>(in_data, in_w, in_h), in_w, in_h)
     {}
 
     void set_and_next(R2Y_ yuv_t const & rhs)
     {
-        (*y_) = rhs.y_; ++y_;
+        (*y_.get()) = rhs.y_;
         R2Y_HELPER_  set_planar_uv(rhs.u_, rhs.v_, uv_);
         R2Y_HELPER_ next_planar_uv(uv_);
+        next(1);
+    }
+
+    template <GLB_ size_t N>
+    void set_rows(R2Y_ detail_rows_::planar_rows<R2Y_ yuv_t, 1, N> const & rhs, GLB_ size_t n)
+    {
+        R2Y_ byte_t * y = y_.get();
+        for (GLB_ size_t i = 0; i < n; ++i) y[i] = static_cast<GLB_ uint8_t>(rhs.a_[0][i]);
+        for (GLB_ size_t i = 0; i < n; ++i)
+        {
+            R2Y_HELPER_  set_planar_uv(static_cast<GLB_ uint8_t>(rhs.b_[0][i]), static_cast<GLB_ uint8_t>(rhs.c_[0][i]), uv_);
+            R2Y_HELPER_ next_planar_uv(uv_);
+        }
+        next(n);
+    }
+
+    void blend_and_next(R2Y_ yuv_t const & rhs, R2Y_ byte_t a)
+    {
+        GLB_ uint8_t u, v;
+        R2Y_HELPER_ get_planar_uv(u, v, uv_);
+        R2Y_ byte_t & y = *y_.get();
+        y = R2Y_ detail_mask_::mix(y, rhs.y_, a);
+        R2Y_HELPER_  set_planar_uv(R2Y_ detail_mask_::mix(u, rhs.u_, a),
+                                   R2Y_ detail_mask_::mix(v, rhs.v_, a), uv_);
+        R2Y_HELPER_ next_planar_uv(uv_);
+        next(1);
+    }
+
+    void skip(GLB_ size_t n)
+    {
+        for (GLB_ size_t i = 0; i < n; ++i) R2Y_HELPER_ next_planar_uv(uv_);
+        next(n);
     }
 };
 
@@ -213,73 +445,109 @@ R2Y_DETAIL_INHERIT_(yuv_NV42, yuv_NV24)
 
 /* 4:2:2 */
 
-template <R2Y_ supported S> class impl_<R2Y_ yuv_422P, S> : R2Y_HELPER_ yuv_planar<S>
+template <R2Y_ supported S> class impl_<R2Y_ yuv_422P, S>
 {
     typedef R2Y_HELPER_ planar_uv_t<S> uv_t;
 
-    R2Y_ byte_t * y_;
-    uv_t          uv_;
+    R2Y_ frame_planes                              f_;
+    R2Y_ detail_iterator_::row_cursor<R2Y_ byte_t> y_;
+    uv_t                                           uv_;
 
 public:
     enum { iterator_size = 2, is_block = 0 };
 
+    impl_(R2Y_ frame_planes const & in_f, GLB_ size_t in_w, GLB_ size_t in_h)
+        : f_(in_f), y_(in_f.data_[0], in_w, in_h, in_f.pitch_[0]), uv_(R2Y_HELPER_ planar_uv_at<S>(in_f, 0))
+    {}
+
     impl_(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h)
-        : R2Y_HELPER_ yuv_planar<S>(y_, uv_, in_data, in_w, in_h)
+        : impl_(R2Y_ detail_layout_::tight_planes<S>(in_data, in_w, in_h), in_w, in_h)
     {}
 
     void set_and_next(R2Y_ yuv_t const (& rhs)[iterator_size])
     {
-        GLB_ uint16_t u_k, v_k;
-        {
-            R2Y_ yuv_t const & pix = rhs[0];
-            (*y_) = pix.y_; ++y_;
-            u_k   = pix.u_;
-            v_k   = pix.v_;
-        }
-        {
-            R2Y_ yuv_t const & pix = rhs[1];
-            (*y_) = pix.y_; ++y_;
-            R2Y_HELPER_ set_planar_uv((u_k + pix.u_) >> 1,
-                                      (v_k + pix.v_) >> 1, uv_);
-            R2Y_HELPER_ next_planar_uv(uv_);
-        }
+        R2Y_ byte_t * y = y_.get();
+        GLB_ size_t   c = (y_.room() < 2) ? 1 : 2; // the tail of an odd row has only one
+        y[0] = rhs[0].y_;
+        if (c > 1) y[1] = rhs[1].y_;
+        R2Y_HELPER_ set_planar_uv((rhs[0].u_ + rhs[1].u_) >> 1,
+                                  (rhs[0].v_ + rhs[1].v_) >> 1, uv_);
+        R2Y_HELPER_ next_planar_uv(uv_);
+        if (y_.next(c)) uv_ = R2Y_HELPER_ planar_uv_at<S>(f_, y_.row());
     }
 };
 
 /* 4:2:0 */
 
-template <R2Y_ supported S> class impl_<R2Y_ yuv_YV12, S> : R2Y_HELPER_ yuv_planar<S>
+template <R2Y_ supported S> class impl_<R2Y_ yuv_YV12, S>
 {
     typedef R2Y_HELPER_ planar_uv_t<S> uv_t;
 
-    R2Y_ byte_t * y_, * y1_, * ye_;
-    uv_t          uv_;
-    GLB_ size_t   w_;
+    R2Y_ frame_planes                                f_;
+    uv_t                                             uv_;
+    R2Y_ detail_iterator_::luma_rows<R2Y_ byte_t, 2> rows_;
+    GLB_ size_t                                      cy_, ch_; // the chroma row, and the chroma rows
+
+    /* The chroma follows the luma to the next rows */
+    void next(bool in_moved)
+    {
+        if (in_moved && ((++cy_) < ch_)) uv_ = R2Y_HELPER_ planar_uv_at<S>(f_, cy_);
+    }
 
 public:
     enum { iterator_size = 2, is_block = 1 };
 
+    impl_(R2Y_ frame_planes const & in_f, GLB_ size_t in_w, GLB_ size_t in_h)
+        : f_(in_f), uv_(R2Y_HELPER_ planar_uv_at<S>(in_f, 0))
+        , rows_(in_f.data_[0], in_w, in_h, in_f.pitch_[0]), cy_(0), ch_((in_h + 1) >> 1)
+    {}
+
     impl_(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h)
-        : R2Y_HELPER_ yuv_planar<S>(y_, uv_, in_data, in_w, in_h)
-        , y1_(y_ + in_w), ye_(y1_)
-        , w_(in_w)
+        : impl_(R2Y_ detail_layout_::tight_planes<S>(in_data, in_w, in_h), in_w, in_h)
     {}
 
     void set_and_next(R2Y_ yuv_t const (& rhs)[iterator_size * iterator_size])
     {
-        (*y_)  = rhs[0].y_; ++y_;
-        (*y_)  = rhs[1].y_; ++y_;
-        (*y1_) = rhs[2].y_; ++y1_;
-        (*y1_) = rhs[3].y_; ++y1_;
-        if (y_ == ye_)
-        {
-            y_ = y1_;
-            y1_ += w_;
-            ye_ = y1_;
-        }
         R2Y_HELPER_ set_planar_uv((rhs[0].u_ + rhs[1].u_ + rhs[2].u_ + rhs[3].u_) >> 2,
                                   (rhs[0].v_ + rhs[1].v_ + rhs[2].v_ + rhs[3].v_) >> 2, uv_);
         R2Y_HELPER_ next_planar_uv(uv_);
+        next(rows_.set_and_next({ rhs[0].y_, rhs[1].y_, rhs[2].y_, rhs[3].y_ }));
+    }
+
+    template <GLB_ size_t N>
+    void set_rows(R2Y_ detail_rows_::planar_rows<R2Y_ yuv_t, 2, N> const & rhs, GLB_ size_t n)
+    {
+        for (GLB_ size_t i = 0; i < n; i += 2)
+        {
+            R2Y_HELPER_ set_planar_uv((rhs.b_[0][i] + rhs.b_[0][i + 1] + rhs.b_[1][i] + rhs.b_[1][i + 1]) >> 2,
+                                      (rhs.c_[0][i] + rhs.c_[0][i + 1] + rhs.c_[1][i] + rhs.c_[1][i + 1]) >> 2, uv_);
+            R2Y_HELPER_ next_planar_uv(uv_);
+        }
+        next(rows_.set_rows(rhs.a_, n));
+    }
+
+    /* Each luma is mixed by its own alpha, the shared chroma by their average */
+    void blend_and_next(R2Y_ yuv_t const (& rhs)[iterator_size * iterator_size],
+                        R2Y_ byte_t const (& a)[iterator_size * iterator_size])
+    {
+        R2Y_ byte_t * y0 = rows_.row(0), * y1 = rows_.row(1);
+        y0[0] = R2Y_ detail_mask_::mix(y0[0], rhs[0].y_, a[0]);
+        y0[1] = R2Y_ detail_mask_::mix(y0[1], rhs[1].y_, a[1]);
+        y1[0] = R2Y_ detail_mask_::mix(y1[0], rhs[2].y_, a[2]);
+        y1[1] = R2Y_ detail_mask_::mix(y1[1], rhs[3].y_, a[3]);
+        GLB_ uint8_t u, v;
+        R2Y_HELPER_ get_planar_uv(u, v, uv_);
+        GLB_ int32_t ac = (a[0] + a[1] + a[2] + a[3] + 2) >> 2;
+        R2Y_HELPER_ set_planar_uv(R2Y_ detail_mask_::mix(u, (rhs[0].u_ + rhs[1].u_ + rhs[2].u_ + rhs[3].u_) >> 2, ac),
+                                  R2Y_ detail_mask_::mix(v, (rhs[0].v_ + rhs[1].v_ + rhs[2].v_ + rhs[3].v_) >> 2, ac), uv_);
+        skip(1);
+    }
+
+    /* n blocks on the same rows */
+    void skip(GLB_ size_t n)
+    {
+        for (GLB_ size_t i = 0; i < n; ++i) R2Y_HELPER_ next_planar_uv(uv_);
+        next(rows_.skip(n));
     }
 };
 
@@ -293,38 +561,31 @@ template <R2Y_ supported S> class impl_<R2Y_ yuv_411P, S> : R2Y_HELPER_ yuv_plan
 {
     typedef R2Y_HELPER_ planar_uv_t<S> uv_t;
 
-    R2Y_ byte_t * y_;
+    R2Y_ byte_t * y_, * ye_;
     uv_t          uv_;
+    GLB_ size_t   w_;
 
 public:
     enum { iterator_size = 4, is_block = 0 };
 
     impl_(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h)
         : R2Y_HELPER_ yuv_planar<S>(y_, uv_, in_data, in_w, in_h)
+        , ye_(y_ + in_w), w_(in_w)
     {}
 
     void set_and_next(R2Y_ yuv_t const (& rhs)[iterator_size])
     {
-        GLB_ uint16_t u_k, v_k;
-
-#   pragma push_macro("R2Y_SET_AND_NEXT_")
-#   undef  R2Y_SET_AND_NEXT_
-#   define R2Y_SET_AND_NEXT_(I, OP, ...) do  \
-        {                                    \
-            R2Y_ yuv_t const & pix = rhs[I]; \
-            (*y_) = pix.y_; ++y_;            \
-            u_k  OP pix.u_;                  \
-            v_k  OP pix.v_;                  \
-            __VA_ARGS__                      \
-        } while(0)
-
-        R2Y_SET_AND_NEXT_(0, = );
-        R2Y_SET_AND_NEXT_(1, +=);
-        R2Y_SET_AND_NEXT_(2, +=);
-        R2Y_SET_AND_NEXT_(3, +=, R2Y_HELPER_  set_planar_uv<S>(u_k >> 2, v_k >> 2, uv_);
-                                 R2Y_HELPER_ next_planar_uv<S>(uv_););
-
-#   pragma pop_macro("R2Y_SET_AND_NEXT_")
+        GLB_ uint16_t u_k = 0, v_k = 0;
+        for (int i = 0; i < iterator_size; ++i)
+        {
+            u_k += rhs[i].u_;
+            v_k += rhs[i].v_;
+        }
+        // The tail of a row may have less than 4
+        for (int i = 0; (i < iterator_size) && (y_ != ye_); ++i, ++y_) (*y_) = rhs[i].y_;
+        if (y_ == ye_) ye_ += w_;
+        R2Y_HELPER_  set_planar_uv<S>(u_k >> 2, v_k >> 2, uv_);
+        R2Y_HELPER_ next_planar_uv<S>(uv_);
     }
 };
 
@@ -334,48 +595,253 @@ template <R2Y_ supported S> class impl_<R2Y_ yuv_YUV9, S> : R2Y_HELPER_ yuv_plan
 {
     typedef R2Y_HELPER_ planar_uv_t<S> uv_t;
 
-    R2Y_ byte_t * y_, * y1_, * y2_, * y3_, * ye_;
-    uv_t          uv_;
-    GLB_ size_t   w_;
+    R2Y_ byte_t *                                y_;
+    uv_t                                         uv_;
+    R2Y_ detail_iterator_::luma_rows<R2Y_ byte_t, 4> rows_;
 
 public:
     enum { iterator_size = 4, is_block = 1 };
 
     impl_(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h)
         : R2Y_HELPER_ yuv_planar<S>(y_, uv_, in_data, in_w, in_h)
-        , y1_(y_ + in_w), y2_(y1_ + in_w), y3_(y2_ + in_w), ye_(y1_)
-        , w_(in_w)
+        , rows_(y_, in_w, in_h, in_w)
     {}
 
     void set_and_next(R2Y_ yuv_t const (& rhs)[iterator_size * iterator_size])
     {
-        int i = 0;
-        for (; i < 4 ; ++i, ++y_ ) (*y_)  = rhs[i].y_;
-        for (; i < 8 ; ++i, ++y1_) (*y1_) = rhs[i].y_;
-        for (; i < 12; ++i, ++y2_) (*y2_) = rhs[i].y_;
-        for (; i < 16; ++i, ++y3_) (*y3_) = rhs[i].y_;
-        if (y_ == ye_)
+        R2Y_ byte_t  luma[iterator_size * iterator_size];
+        GLB_ int32_t u_k = 0, v_k = 0;
+        for (int i = 0; i < (iterator_size * iterator_size); ++i)
         {
-            y_  = y3_;
-            y1_ = y_  + w_;
-            y2_ = y1_ + w_;
-            y3_ = y2_ + w_;
-            ye_ = y1_;
+            luma[i] = rhs[i].y_;
+            u_k    += rhs[i].u_;
+            v_k    += rhs[i].v_;
         }
-        R2Y_HELPER_ set_planar_uv((rhs[0 ].u_ + rhs[1 ].u_ + rhs[2 ].u_ + rhs[3 ].u_ +
-                                   rhs[4 ].u_ + rhs[5 ].u_ + rhs[6 ].u_ + rhs[7 ].u_ +
-                                   rhs[8 ].u_ + rhs[9 ].u_ + rhs[10].u_ + rhs[11].u_ +
-                                   rhs[12].u_ + rhs[13].u_ + rhs[14].u_ + rhs[15].u_) >> 4,
-                                  (rhs[0 ].v_ + rhs[1 ].v_ + rhs[2 ].v_ + rhs[3 ].v_ +
-                                   rhs[4 ].v_ + rhs[5 ].v_ + rhs[6 ].v_ + rhs[7 ].v_ +
-                                   rhs[8 ].v_ + rhs[9 ].v_ + rhs[10].v_ + rhs[11].v_ +
-                                   rhs[12].v_ + rhs[13].v_ + rhs[14].v_ + rhs[15].v_) >> 4, uv_);
+        rows_.set_and_next(luma);
+        R2Y_HELPER_ set_planar_uv(u_k >> 4, v_k >> 4, uv_);
         R2Y_HELPER_ next_planar_uv(uv_);
     }
 };
 
 R2Y_DETAIL_INHERIT_(yuv_YVU9, yuv_YUV9)
 
+/* 4:2:0, 10-bit */
+
+template <R2Y_ supported S> class impl_<R2Y_ yuv_P010, S>
+{
+    GLB_ uint16_t *                                 uv_;
+    R2Y_ detail_iterator_::luma_rows<GLB_ uint16_t, 2> rows_;
+
+public:
+    enum { iterator_size = 2, is_block = 1 };
+
+    impl_(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h)
+        : uv_(reinterpret_cast<GLB_ uint16_t *>(in_data) + (in_w * in_h))
+        , rows_(reinterpret_cast<GLB_ uint16_t *>(in_data), in_w, in_h, in_w * sizeof(GLB_ uint16_t))
+    {}
+
+    void set_and_next(R2Y_ yuv16_t const (& rhs)[iterator_size * iterator_size])
+    {
+        rows_.set_and_next({ static_cast<GLB_ uint16_t>(rhs[0].y_ << 6), static_cast<GLB_ uint16_t>(rhs[1].y_ << 6),
+                             static_cast<GLB_ uint16_t>(rhs[2].y_ << 6), static_cast<GLB_ uint16_t>(rhs[3].y_ << 6) });
+        uv_[0] = static_cast<GLB_ uint16_t>(((rhs[0].u_ + rhs[1].u_ + rhs[2].u_ + rhs[3].u_) >> 2) << 6);
+        uv_[1] = static_cast<GLB_ uint16_t>(((rhs[0].v_ + rhs[1].v_ + rhs[2].v_ + rhs[3].v_) >> 2) << 6);
+        uv_ += 2;
+    }
+};
+
+/* 4:2:0, block ordered */
+
+template <R2Y_ supported S> class impl_<R2Y_ yuv_MB16, S>
+{
+    R2Y_ byte_t * blk_;
+
+public:
+    enum { iterator_size = R2Y_ block_size<S>::value, is_block = 1 };
+
+    impl_(R2Y_ byte_t * in_data, GLB_ size_t /*in_w*/, GLB_ size_t /*in_h*/)
+        : blk_(in_data)
+    {}
+
+    void set_and_next(R2Y_ yuv_t const (& rhs)[iterator_size * iterator_size])
+    {
+        for (int i = 0; i < (iterator_size * iterator_size); ++i)
+        {
+            blk_[i] = rhs[i].y_;
+        }
+        blk_ += (iterator_size * iterator_size);
+        // The chroma pairs are in the same order as NV12
+        R2Y_HELPER_ planar_uv_t<R2Y_ yuv_NV12> uv;
+        uv.uv_ = reinterpret_cast<decltype(uv.uv_)>(blk_);
+        for (int i = 0; i < iterator_size; i += 2)
+        {
+            for (int j = 0; j < iterator_size; j += 2)
+            {
+                R2Y_ yuv_t const * pix = rhs + (i * iterator_size) + j;
+                R2Y_HELPER_ set_planar_uv((pix[0].u_ + pix[1].u_ + pix[iterator_size].u_ + pix[iterator_size + 1].u_) >> 2,
+                                          (pix[0].v_ + pix[1].v_ + pix[iterator_size].v_ + pix[iterator_size + 1].v_) >> 2, uv);
+                R2Y_HELPER_ next_planar_uv(uv);
+            }
+        }
+        blk_ += ((iterator_size * iterator_size) >> 1);
+    }
+};
+
+R2Y_DETAIL_INHERIT_(yuv_MB32, yuv_MB16)
+R2Y_DETAIL_INHERIT_(yuv_MB64, yuv_MB16)
+
+/* Luma only */
+
+template <R2Y_ supported S> class impl_<R2Y_ yuv_Y800, S>
+{
+    R2Y_ detail_iterator_::row_cursor<R2Y_ byte_t> y_;
+
+public:
+    enum { iterator_size = 1, is_block = 0 };
+
+    impl_(R2Y_ frame_planes const & in_f, GLB_ size_t in_w, GLB_ size_t in_h)
+        : y_(in_f.data_[0], in_w, in_h, in_f.pitch_[0])
+    {}
+
+    impl_(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h)
+        : y_(in_data, in_w, in_h, in_w)
+    {}
+
+    void set_and_next(R2Y_ yuv_t const & rhs)
+    {
+        (*y_.get()) = rhs.y_;
+        y_.next(1);
+    }
+
+    template <GLB_ size_t N>
+    void set_and_next(R2Y_ yuv_t const (&rhs)[N])
+    {
+        for (GLB_ size_t i = 0; i < N; ++i)
+        {
+            set_and_next(rhs[i]);
+        }
+    }
+
+    template <GLB_ size_t N>
+    void set_rows(R2Y_ detail_rows_::planar_rows<R2Y_ yuv_t, 1, N> const & rhs, GLB_ size_t n)
+    {
+        R2Y_ byte_t * y = y_.get();
+        for (GLB_ size_t i = 0; i < n; ++i)
+        {
+            y[i] = static_cast<R2Y_ byte_t>(rhs.a_[0][i]);
+        }
+        y_.next(n);
+    }
+
+    void blend_and_next(R2Y_ yuv_t const & rhs, R2Y_ byte_t a)
+    {
+        R2Y_ byte_t & y = *y_.get();
+        y = R2Y_ detail_mask_::mix(y, rhs.y_, a);
+        y_.next(1);
+    }
+
+    void skip(GLB_ size_t n)
+    {
+        y_.next(n);
+    }
+};
+
+/* YCoCg/YCoCg-R/RCT/ICT, 4:4:4 planar */
+
+template <R2Y_ supported S> class impl_<R2Y_ ycc_YCoCg, S>
+{
+    typedef R2Y_ detail_ycc_::color_transform<S> transform_t;
+    typedef typename transform_t::sample_t       sample_t;
+
+    sample_t * c0_, * c1_, * c2_;
+
+public:
+    enum { iterator_size = 1, is_block = 0 };
+
+    impl_(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h)
+        : c0_(reinterpret_cast<sample_t *>(in_data)), c1_(c0_ + (in_w * in_h)), c2_(c1_ + (in_w * in_h))
+    {}
+
+    void set_and_next(R2Y_ rgb_t const & rhs)
+    {
+        transform_t::forward(rhs, *c0_, *c1_, *c2_);
+        ++c0_; ++c1_; ++c2_;
+    }
+
+    template <GLB_ size_t N>
+    void set_and_next(R2Y_ rgb_t const (&rhs)[N])
+    {
+        for (GLB_ size_t i = 0; i < N; ++i)
+        {
+            set_and_next(rhs[i]);
+        }
+    }
+};
+
+R2Y_DETAIL_INHERIT_(ycc_YCoCgR, ycc_YCoCg)
+R2Y_DETAIL_INHERIT_(ycc_RCT   , ycc_YCoCg)
+R2Y_DETAIL_INHERIT_(ycc_ICT   , ycc_YCoCg)
+
+/* JPEG MCU, full range YCbCr (JFIF) with the transform of ICT */
+
+template <R2Y_ supported S> class impl_<R2Y_ jpg_MCU444, S>
+{
+    GLB_ int16_t * blk_;
+
+public:
+    enum { iterator_size = 8, is_block = 1 };
+
+    impl_(R2Y_ byte_t * in_data, GLB_ size_t /*in_w*/, GLB_ size_t /*in_h*/)
+        : blk_(reinterpret_cast<GLB_ int16_t *>(in_data))
+    {}
+
+    void set_and_next(R2Y_ rgb_t const (& rhs)[iterator_size * iterator_size])
+    {
+        GLB_ int16_t * cb = blk_ + 64, * cr = cb + 64;
+        for (int i = 0; i < 64; ++i)
+        {
+            R2Y_ detail_ycc_::ict_forward(rhs[i], blk_[i], cb[i], cr[i]);
+        }
+        blk_ += (64 * 3);
+    }
+};
+
+template <R2Y_ supported S> class impl_<R2Y_ jpg_MCU420, S>
+{
+    GLB_ int16_t * blk_;
+
+public:
+    enum { iterator_size = 16, is_block = 1 };
+
+    impl_(R2Y_ byte_t * in_data, GLB_ size_t /*in_w*/, GLB_ size_t /*in_h*/)
+        : blk_(reinterpret_cast<GLB_ int16_t *>(in_data))
+    {}
+
+    void set_and_next(R2Y_ rgb_t const (& rhs)[iterator_size * iterator_size])
+    {
+        GLB_ int32_t cb_sum[64] = {}, cr_sum[64] = {}; // of each 2x2
+        for (int i = 0; i < 16; ++i)
+        {
+            // Y0 Y1 on the upper half, Y2 Y3 on the lower half
+            GLB_ int16_t * y = blk_ + ((i >> 3) << 7) + ((i & 7) << 3);
+            for (int j = 0; j < 16; ++j)
+            {
+                GLB_ int16_t cb, cr;
+                R2Y_ detail_ycc_::ict_forward(rhs[(i << 4) + j], y[(j & 7) + ((j >> 3) << 6)], cb, cr);
+                cb_sum[((i >> 1) << 3) + (j >> 1)] += cb;
+                cr_sum[((i >> 1) << 3) + (j >> 1)] += cr;
+            }
+        }
+        GLB_ int16_t * cb = blk_ + (64 * 4), * cr = cb + 64;
+        for (int k = 0; k < 64; ++k)
+        {
+            cb[k] = static_cast<GLB_ int16_t>((cb_sum[k] + 2) >> 2);
+            cr[k] = static_cast<GLB_ int16_t>((cr_sum[k] + 2) >> 2);
+        }
+        blk_ += (64 * 6);
+    }
+};
+
 #pragma pop_macro("R2Y_DETAIL_INHERIT_")
 #pragma pop_macro("R2Y_HELPER_")
 #pragma pop_macro("R2Y_DETAIL_")
@@ -0,0 +1,80 @@
+/*
+    rgb2yuv - Code covered by the MIT License
+    Author: mutouyun (http://orzz.org)
+*/
+
+////////////////////////////////////////////////////////////////
+/// Masks selecting which pixels of a frame are converted
+////////////////////////////////////////////////////////////////
+
+enum mask_format
+{
+    mask_1BIT,  // 1 bit per pixel, MSB first, each row padded to whole bytes
+    mask_8BIT,  // 1 byte per pixel, 0 keeps the old pixel, 255 replaces it, others blend
+    mask_MAX
+};
+
+struct mask
+{
+    R2Y_ byte_t const * data_;
+    R2Y_ mask_format    fmt_;
+};
+
+namespace detail_mask_ {
+
+enum coverage
+{
+    cover_NONE,
+    cover_PART,
+    cover_FULL
+};
+
+class mask_reader
+{
+    R2Y_ byte_t const * data_;
+    R2Y_ mask_format    fmt_;
+    GLB_ size_t         stride_;
+
+public:
+    enum { chunk_size = 8 };
+
+    mask_reader(R2Y_ mask const & m, GLB_ size_t in_w)
+        : data_(m.data_), fmt_(m.fmt_)
+        , stride_((m.fmt_ == R2Y_ mask_1BIT) ? ((in_w + 7) >> 3) : in_w)
+    {}
+
+    /*
+     * The coverage of the chunk_size pixels from (x, y), x must be a multiple of chunk_size.
+     * A whole chunk is tested at once: one byte of a 1-bit mask, or 8 bytes of an 8-bit mask.
+     */
+    R2Y_FORCE_INLINE_ R2Y_ detail_mask_::coverage chunk(GLB_ size_t x, GLB_ size_t y) const
+    {
+        if (fmt_ == R2Y_ mask_1BIT)
+        {
+            R2Y_ byte_t bits = data_[y * stride_ + (x >> 3)];
+            return (bits == 0) ? R2Y_ detail_mask_::cover_NONE :
+                   (bits == 0xFF) ? R2Y_ detail_mask_::cover_FULL : R2Y_ detail_mask_::cover_PART;
+        }
+        GLB_ uint64_t bytes;
+        memcpy(&bytes, data_ + (y * stride_ + x), sizeof(bytes));
+        return (bytes == 0) ? R2Y_ detail_mask_::cover_NONE :
+               (bytes == ~static_cast<GLB_ uint64_t>(0)) ? R2Y_ detail_mask_::cover_FULL : R2Y_ detail_mask_::cover_PART;
+    }
+
+    R2Y_FORCE_INLINE_ R2Y_ byte_t alpha(GLB_ size_t x, GLB_ size_t y) const
+    {
+        if (fmt_ == R2Y_ mask_1BIT)
+        {
+            return ((data_[y * stride_ + (x >> 3)] >> (7 - (x & 7))) & 1) ? 0xFF : 0;
+        }
+        return data_[y * stride_ + x];
+    }
+};
+
+/* Mix the old and the new value by a (in 1/255) */
+R2Y_FORCE_INLINE_ GLB_ uint8_t mix(GLB_ int32_t o, GLB_ int32_t n, GLB_ int32_t a)
+{
+    return static_cast<GLB_ uint8_t>( (o * (255 - a) + n * a + 127) / 255 );
+}
+
+} // namespace detail_mask_
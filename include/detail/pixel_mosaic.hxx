@@ -0,0 +1,199 @@
+/*
+    rgb2yuv - Code covered by the MIT License
+    Author: mutouyun (http://orzz.org)
+*/
+
+////////////////////////////////////////////////////////////////
+/// Composing many sources into one frame (a mosaic, or a video wall)
+////////////////////////////////////////////////////////////////
+
+namespace detail_mosaic_ {
+
+/* A source of any format, decoded one row at a time */
+
+class row_source
+{
+public:
+    virtual ~row_source(void) {}
+    virtual void decode(GLB_ size_t y, R2Y_ rgb_t * line) = 0;
+};
+
+template <R2Y_ supported S>
+class row_source_of : public R2Y_ detail_mosaic_::row_source
+{
+    decltype(R2Y_ detail_walker_::make_pixels<S>(NULL, 0, 0, 0)) get_;
+    GLB_ size_t w_;
+
+public:
+    row_source_of(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h)
+        : get_(R2Y_ detail_walker_::make_pixels<S>(in_data, in_w, in_h, 3)), w_(in_w)
+    {}
+
+    void decode(GLB_ size_t y, R2Y_ rgb_t * line) override
+    {
+        for (GLB_ size_t x = 0; x < w_; ++x) line[x] = get_(x, y);
+    }
+};
+
+} // namespace detail_mosaic_
+
+/*
+ * A source placed on the output frame: scaled from w_ * h_ into the rectangle
+ * (x_, y_, dw_, dh_). Created by make_tile<S>, which records the source format.
+ * open_ returns NULL if out of memory, then the tile is left out (showing the background).
+ */
+struct tile
+{
+    R2Y_ byte_t * data_;
+    GLB_ size_t   w_, h_;
+    GLB_ size_t   x_, y_, dw_, dh_;
+    R2Y_ detail_mosaic_::row_source * (* open_)(R2Y_ tile const &);
+};
+
+template <R2Y_ supported S>
+STD_ enable_if_t<(R2Y_ is_rgb<S>::value || R2Y_ is_bayer<S>::value || R2Y_ is_ycc<S>::value) && (S != R2Y_ rgb_161616),
+R2Y_ tile> make_tile(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h,
+                     GLB_ size_t ot_x, GLB_ size_t ot_y, GLB_ size_t ot_w, GLB_ size_t ot_h)
+{
+    return
+    {
+        in_data, in_w, in_h, ot_x, ot_y, ot_w, ot_h,
+        [](R2Y_ tile const & t) -> R2Y_ detail_mosaic_::row_source *
+        {
+            return new (STD_ nothrow) R2Y_ detail_mosaic_::row_source_of<S>(t.data_, t.w_, t.h_);
+        }
+    };
+}
+
+namespace detail_mosaic_ {
+
+/*
+ * Scale the sources into their rectangles on demand, a group of output rows at a time,
+ * and hand out the pixel of the topmost tile covering each output position.
+ * Not valid() if out of memory, a tile whose scaler is out of memory is left out.
+ */
+class compositor
+{
+    typedef R2Y_ detail_scale_::area_scaler<R2Y_ rgb_t> scaler_t;
+
+    struct state_t
+    {
+        R2Y_ tile const &               tile_;
+        R2Y_ detail_mosaic_::row_source * src_;
+        scaler_t                        scaler_;
+        R2Y_ scope_block<R2Y_ rgb_t>    line_;
+        GLB_ size_t                     src_y_;  // the next source row to decode
+        bool                            loaded_; // line_ holds the row src_y_
+    };
+
+    R2Y_ scope_block<state_t>      states_;
+    GLB_ size_t                    count_, group_;
+    R2Y_ scope_block<GLB_ int32_t> owner_; // the tile on each column of the current rows, -1 is none
+    R2Y_ rgb_t                     bg_;
+
+    /* Scale the rows [y, y + group) of the tile, relative to its rectangle */
+    void fill(state_t & st, GLB_ size_t y)
+    {
+        while (st.scaler_.done() < (y + group_))
+        {
+            if (!st.loaded_)
+            {
+                st.src_->decode(st.src_y_, st.line_.data());
+                st.loaded_ = true;
+            }
+            if (!st.scaler_.feed(st.line_.data(), st.src_y_))
+            {
+                st.loaded_ = false;
+                ++(st.src_y_);
+            }
+        }
+    }
+
+public:
+    compositor(R2Y_ tile const * tiles, GLB_ size_t count, GLB_ size_t ot_w, GLB_ size_t ot_h,
+               GLB_ size_t in_group, R2Y_ rgb_t const & background)
+        : states_(count), count_(count), group_(in_group), owner_(ot_w), bg_(background)
+    {
+        (void)ot_h;
+        if (!this->valid())
+        {
+            count_ = 0;
+            return;
+        }
+        for (GLB_ size_t i = 0; i < count; ++i)
+        {
+            R2Y_ tile const & t = tiles[i];
+            assert(t.data_ != NULL && t.open_ != NULL);
+            assert(t.w_ > 0 && t.h_ > 0 && t.dw_ > 0 && t.dh_ > 0);
+            assert((t.x_ + t.dw_) <= ot_w && (t.y_ + t.dh_) <= ot_h);
+            assert((t.y_ % in_group) == 0 && (t.dh_ % in_group) == 0);
+            new (&states_[i]) state_t{ t, t.open_(t), scaler_t{ t.w_, t.h_, t.dw_, t.dh_, in_group },
+                                       R2Y_ scope_block<R2Y_ rgb_t>{ t.w_ }, 0, false };
+        }
+    }
+
+    ~compositor(void)
+    {
+        for (GLB_ size_t i = 0; i < count_; ++i)
+        {
+            delete states_[i].src_;
+            states_[i].~state_t();
+        }
+    }
+
+    bool valid(void) const
+    {
+        return ((states_.data() != NULL) || (count_ == 0)) && (owner_.data() != NULL);
+    }
+
+    /* Get the rows [y, y + group) of every tile covering them ready, later tiles on top */
+    void prepare(GLB_ size_t y)
+    {
+        GLB_ size_t w = owner_.count();
+        for (GLB_ size_t x = 0; x < w; ++x) owner_[x] = -1;
+        for (GLB_ size_t i = 0; i < count_; ++i)
+        {
+            state_t & st = states_[i];
+            R2Y_ tile const & t = st.tile_;
+            if ((y < t.y_) || (y >= (t.y_ + t.dh_))) continue;
+            if ((st.src_ == NULL) || (st.line_.data() == NULL) || !st.scaler_.valid()) continue; // failed to open
+            this->fill(st, y - t.y_);
+            for (GLB_ size_t x = t.x_; x < (t.x_ + t.dw_); ++x)
+            {
+                owner_[x] = static_cast<GLB_ int32_t>(i);
+            }
+        }
+    }
+
+    R2Y_FORCE_INLINE_ R2Y_ rgb_t operator()(GLB_ size_t x, GLB_ size_t y) const
+    {
+        GLB_ int32_t i = owner_[x];
+        if (i < 0) return bg_;
+        state_t const & st = states_[i];
+        return st.scaler_(x - st.tile_.x_, y - st.tile_.y_);
+    }
+};
+
+} // namespace detail_mosaic_
+
+/*
+ * Walk the output frame once, in the shape the closure asks for.
+ * No source is converted into a buffer of its own: each is scaled row by row
+ * and converted straight into its rectangle, the uncovered pixels are filled with the background.
+ * Returns false if out of memory, then the frame is left untouched.
+ */
+template <typename Conv>
+bool mosaic_foreach(R2Y_ tile const * tiles, GLB_ size_t count, GLB_ size_t ot_w, GLB_ size_t ot_h,
+                    R2Y_ rgb_t const & background, Conv && do_sth)
+{
+    enum { group = STD_ decay_t<Conv>::is_block ? STD_ decay_t<Conv>::iterator_size : 1 };
+
+    R2Y_ detail_mosaic_::compositor comp{ tiles, count, ot_w, ot_h, group, background };
+    if (!comp.valid()) return false;
+    for (GLB_ size_t y = 0; y < ot_h; y += group)
+    {
+        comp.prepare(y);
+        R2Y_ detail_walker_::foreach_rows(ot_w, y, y + group, comp, do_sth);
+    }
+    return true;
+}
@@ -0,0 +1,218 @@
+/*
+    rgb2yuv - Code covered by the MIT License
+    Author: mutouyun (http://orzz.org)
+*/
+
+////////////////////////////////////////////////////////////////
+/// Stages fused into the fetcher of a single walk
+////////////////////////////////////////////////////////////////
+
+namespace detail_pipe_ {
+
+/*
+ * The fetchers of the stages, each wrapping the one of the previous stage.
+ * They are not const, for the fetchers caching rows (e.g. Bayer RAW10/RAW12) are not.
+ */
+
+/* The pixels of a rectangle of the previous stage */
+template <typename G>
+struct crop_pixels
+{
+    G           get_;
+    GLB_ size_t x_, y_;
+
+    R2Y_FORCE_INLINE_ auto operator()(GLB_ size_t x, GLB_ size_t y) -> decltype(get_(x, y))
+    {
+        return get_(x + x_, y + y_);
+    }
+};
+
+/* The average of each N x N box of the previous stage */
+template <typename G, GLB_ size_t N>
+struct box_pixels
+{
+    G get_;
+
+    R2Y_FORCE_INLINE_ auto operator()(GLB_ size_t x, GLB_ size_t y) -> STD_ decay_t<decltype(get_(x, y))>
+    {
+        R2Y_ detail_scale_::sum3_t s = {};
+        for (GLB_ size_t j = 0; j < N; ++j)
+        {
+            for (GLB_ size_t i = 0; i < N; ++i)
+            {
+                R2Y_ detail_scale_::accumulate(s, get_((x * N) + i, (y * N) + j));
+            }
+        }
+        STD_ decay_t<decltype(get_(x, y))> ret;
+        R2Y_ detail_scale_::average(s, N * N, ret);
+        return ret;
+    }
+};
+
+/*
+ * A stage maps the size of the previous one to its own (size),
+ * and wraps the fetcher of the previous one (wrap).
+ * scale: how many rows of the previous stage a row of this one touches.
+ */
+
+struct crop_stage
+{
+    enum : GLB_ size_t { scale = 1 };
+
+    GLB_ size_t x_, y_, w_, h_;
+
+    void size(GLB_ size_t & io_w, GLB_ size_t & io_h) const
+    {
+        assert(w_ > 0 && h_ > 0);
+        assert((x_ + w_) <= io_w && (y_ + h_) <= io_h);
+        io_w = w_;
+        io_h = h_;
+    }
+
+    template <typename G>
+    R2Y_ detail_pipe_::crop_pixels<G> wrap(G && get) const
+    {
+        return { STD_ move(get), x_, y_ };
+    }
+};
+
+template <GLB_ size_t N>
+struct downscale_stage
+{
+    enum : GLB_ size_t { scale = N };
+
+    void size(GLB_ size_t & io_w, GLB_ size_t & io_h) const
+    {
+        assert(io_w >= N && io_h >= N);
+        io_w /= N; // the pixels left over on the right and bottom are dropped
+        io_h /= N;
+    }
+
+    template <typename G>
+    R2Y_ detail_pipe_::box_pixels<G, N> wrap(G && get) const
+    {
+        return { STD_ move(get) };
+    }
+};
+
+template <typename... Stages>
+struct scale_of;
+
+template <>
+struct scale_of<> : STD_ integral_constant<GLB_ size_t, 1> {};
+
+template <typename T, typename... Stages>
+struct scale_of<T, Stages...> : STD_ integral_constant<GLB_ size_t, T::scale * scale_of<Stages...>::value> {};
+
+/* The formats with a fetcher of rgb_t or yuv_t, which a pipeline can start from */
+template <R2Y_ supported S, typename = void>
+struct fetchable : STD_ false_type {};
+
+template <R2Y_ supported S>
+struct fetchable<S, STD_ enable_if_t<STD_ is_same<decltype(R2Y_ detail_walker_::make_pixels<S>(STD_ declval<R2Y_ byte_t *>(), 1, 1, 1)(0, 0)), R2Y_ rgb_t>::value ||
+                                     STD_ is_same<decltype(R2Y_ detail_walker_::make_pixels<S>(STD_ declval<R2Y_ byte_t *>(), 1, 1, 1)(0, 0)), R2Y_ yuv_t>::value>>
+    : STD_ true_type {};
+
+} // namespace detail_pipe_
+
+/*
+ * The stages from the source S, not run until it ends with a format (see to<Ot>):
+ * e.g. auto nv12 = (from<rgb_565>() | crop(0, 0, 1280, 720) | downscale<2>() | to<yuv_NV12>())(in_data, in_w, in_h);
+ * The stages are nested into one fetcher, so the source is walked once, with nothing in between.
+ */
+template <R2Y_ supported S, typename... Stages>
+class pipeline
+{
+    STD_ tuple<Stages...> stages_;
+
+    template <GLB_ size_t I, typename G, typename F>
+    auto chain(G get, GLB_ size_t in_w, GLB_ size_t in_h, F && with) const
+        -> STD_ enable_if_t<(I == sizeof...(Stages))>
+    {
+        STD_ forward<F>(with)(get, in_w, in_h);
+    }
+
+    template <GLB_ size_t I, typename G, typename F>
+    auto chain(G get, GLB_ size_t in_w, GLB_ size_t in_h, F && with) const
+        -> STD_ enable_if_t<(I < sizeof...(Stages))>
+    {
+        auto const & st = STD_ get<I>(stages_);
+        st.size(in_w, in_h);
+        this->chain<I + 1>(st.wrap(STD_ move(get)), in_w, in_h, STD_ forward<F>(with));
+    }
+
+    template <GLB_ size_t I>
+    auto resize(GLB_ size_t & /*io_w*/, GLB_ size_t & /*io_h*/) const
+        -> STD_ enable_if_t<(I == sizeof...(Stages))>
+    {}
+
+    template <GLB_ size_t I>
+    auto resize(GLB_ size_t & io_w, GLB_ size_t & io_h) const
+        -> STD_ enable_if_t<(I < sizeof...(Stages))>
+    {
+        STD_ get<I>(stages_).size(io_w, io_h);
+        this->resize<I + 1>(io_w, io_h);
+    }
+
+public:
+    enum : GLB_ size_t { scale = R2Y_ detail_pipe_::scale_of<Stages...>::value };
+
+    pipeline(void) = default;
+
+    explicit pipeline(STD_ tuple<Stages...> const & stages)
+        : stages_(stages)
+    {}
+
+    STD_ tuple<Stages...> const & stages(void) const { return stages_; }
+
+    /* The size after all the stages */
+    void size(GLB_ size_t & io_w, GLB_ size_t & io_h) const
+    {
+        this->resize<0>(io_w, io_h);
+    }
+
+    /*
+     * Call with(get, w, h) with the fetcher and the size after all the stages.
+     * in_rows: how many consecutive rows of the last stage a walk step may touch.
+     */
+    template <typename F>
+    void fetch(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, GLB_ size_t in_rows, F && with) const
+    {
+        this->chain<0>(R2Y_ detail_walker_::make_pixels<S>(in_data, in_w, in_h, (in_rows * scale) + 2),
+                       in_w, in_h, STD_ forward<F>(with));
+    }
+};
+
+template <R2Y_ supported S>
+auto from(void) -> STD_ enable_if_t<R2Y_ detail_pipe_::fetchable<S>::value, R2Y_ pipeline<S>>
+{
+    return {};
+}
+
+/* The rectangle [x, x + w) x [y, y + h) */
+inline R2Y_ detail_pipe_::crop_stage crop(GLB_ size_t x, GLB_ size_t y, GLB_ size_t w, GLB_ size_t h)
+{
+    return { x, y, w, h };
+}
+
+/* Averaging each N x N box into a pixel */
+template <GLB_ size_t N>
+R2Y_ detail_pipe_::downscale_stage<N> downscale(void)
+{
+    static_assert(N > 0, "The factor of downscaling must be positive.");
+    return {};
+}
+
+template <R2Y_ supported S, typename... Stages>
+R2Y_ pipeline<S, Stages..., R2Y_ detail_pipe_::crop_stage>
+    operator|(R2Y_ pipeline<S, Stages...> const & p, R2Y_ detail_pipe_::crop_stage const & st)
+{
+    return R2Y_ pipeline<S, Stages..., R2Y_ detail_pipe_::crop_stage>{ STD_ tuple_cat(p.stages(), STD_ make_tuple(st)) };
+}
+
+template <R2Y_ supported S, typename... Stages, GLB_ size_t N>
+R2Y_ pipeline<S, Stages..., R2Y_ detail_pipe_::downscale_stage<N>>
+    operator|(R2Y_ pipeline<S, Stages...> const & p, R2Y_ detail_pipe_::downscale_stage<N> const & st)
+{
+    return R2Y_ pipeline<S, Stages..., R2Y_ detail_pipe_::downscale_stage<N>>{ STD_ tuple_cat(p.stages(), STD_ make_tuple(st)) };
+}
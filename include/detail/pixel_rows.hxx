@@ -0,0 +1,70 @@
+/*
+    rgb2yuv - Code covered by the MIT License
+    Author: mutouyun (http://orzz.org)
+*/
+
+////////////////////////////////////////////////////////////////
+/// Planar rows between a walker, a closure and an iterator
+////////////////////////////////////////////////////////////////
+
+namespace detail_rows_ {
+
+/*
+ * R rows of up to N pixels of P (rgb_t or yuv_t), a plane of 16-bit lanes for each channel:
+ * a_ is R/Y, b_ is G/U, c_ is B/V.
+ * A block walk gives the rows of its blocks (R is the block size), a row walk one row (R is 1).
+ * The columns are always a whole number of the iterator's steps, the last one may be replicated from the edge.
+ */
+template <typename P, int R, GLB_ size_t N = 64>
+struct planar_rows
+{
+    typedef P pixel_t;
+    enum : GLB_ size_t { size = N };
+
+    GLB_ int16_t a_[R][N], b_[R][N], c_[R][N];
+};
+
+template <int R, GLB_ size_t N>
+R2Y_FORCE_INLINE_ void put(R2Y_ detail_rows_::planar_rows<R2Y_ rgb_t, R, N> & ot_rows, int r, GLB_ size_t i, R2Y_ rgb_t const & pix)
+{
+    ot_rows.a_[r][i] = pix.r_;
+    ot_rows.b_[r][i] = pix.g_;
+    ot_rows.c_[r][i] = pix.b_;
+}
+
+template <int R, GLB_ size_t N>
+R2Y_FORCE_INLINE_ void put(R2Y_ detail_rows_::planar_rows<R2Y_ yuv_t, R, N> & ot_rows, int r, GLB_ size_t i, R2Y_ yuv_t const & pix)
+{
+    ot_rows.a_[r][i] = pix.y_;
+    ot_rows.b_[r][i] = pix.u_;
+    ot_rows.c_[r][i] = pix.v_;
+}
+
+template <typename F, typename = void>
+struct is_planar : STD_ false_type {};
+
+template <typename F>
+struct is_planar<F, STD_ enable_if_t<(F::is_planar != 0)>> : STD_ true_type {};
+
+/* Whether an iterator takes planar rows of R rows of the pixels P as they are (by defining a set_rows) */
+
+template <typename I, typename P, int R, typename = void>
+struct has_set_rows : STD_ false_type {};
+
+template <typename I, typename P, int R>
+struct has_set_rows<I, P, R, decltype(STD_ declval<I &>().set_rows(STD_ declval<R2Y_ detail_rows_::planar_rows<P, R> const &>(),
+                                                                   GLB_ size_t{}))> : STD_ true_type {};
+
+template <typename F, typename P>
+struct takes_rows : STD_ integral_constant<bool, R2Y_ detail_rows_::is_planar<F>::value &&
+                                                 (STD_ is_same<P, R2Y_ rgb_t>::value || STD_ is_same<P, R2Y_ yuv_t>::value)> {};
+
+/* Hand planar rows to an iterator taking them as they are (see has_set_rows) */
+
+template <typename I, typename P, int R, GLB_ size_t N>
+R2Y_FORCE_INLINE_ void set_rows(I & it, R2Y_ detail_rows_::planar_rows<P, R, N> const & in_rows, GLB_ size_t in_n)
+{
+    it.set_rows(in_rows, in_n);
+}
+
+} // namespace detail_rows_
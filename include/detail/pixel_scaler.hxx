@@ -0,0 +1,258 @@
+/*
+    rgb2yuv - Code covered by the MIT License
+    Author: mutouyun (http://orzz.org)
+*/
+
+////////////////////////////////////////////////////////////////
+/// Scaling images while walking them
+////////////////////////////////////////////////////////////////
+
+namespace detail_scale_ {
+
+/* Sums of the 3 channels of a box of pixels */
+
+struct sum3_t { GLB_ uint32_t c0_, c1_, c2_; };
+
+R2Y_FORCE_INLINE_ void accumulate(R2Y_ detail_scale_::sum3_t & s, R2Y_ rgb_t const & p)
+{
+    s.c0_ += p.b_; s.c1_ += p.g_; s.c2_ += p.r_;
+}
+
+R2Y_FORCE_INLINE_ void accumulate(R2Y_ detail_scale_::sum3_t & s, R2Y_ yuv_t const & p)
+{
+    s.c0_ += p.v_; s.c1_ += p.u_; s.c2_ += p.y_;
+}
+
+R2Y_FORCE_INLINE_ void average(R2Y_ detail_scale_::sum3_t const & s, GLB_ uint32_t n, R2Y_ rgb_t & p)
+{
+    GLB_ uint32_t h = n >> 1;
+    p.b_ = static_cast<GLB_ uint8_t>((s.c0_ + h) / n);
+    p.g_ = static_cast<GLB_ uint8_t>((s.c1_ + h) / n);
+    p.r_ = static_cast<GLB_ uint8_t>((s.c2_ + h) / n);
+}
+
+R2Y_FORCE_INLINE_ void average(R2Y_ detail_scale_::sum3_t const & s, GLB_ uint32_t n, R2Y_ yuv_t & p)
+{
+    GLB_ uint32_t h = n >> 1;
+    p.v_ = static_cast<GLB_ uint8_t>((s.c0_ + h) / n);
+    p.u_ = static_cast<GLB_ uint8_t>((s.c1_ + h) / n);
+    p.y_ = static_cast<GLB_ uint8_t>((s.c2_ + h) / n);
+}
+
+/*
+ * The source box of each target coordinate along one axis: [begin(i), end(i)),
+ * never empty, so upscaling picks the nearest source pixel.
+ * Not valid() if out of memory.
+ */
+class axis_map
+{
+    R2Y_ scope_block<GLB_ uint32_t> edge_; // [begin, end) of each target coordinate
+
+public:
+    axis_map(GLB_ size_t in_n, GLB_ size_t ot_n)
+        : edge_(ot_n * 2)
+    {
+        if (!this->valid()) return;
+        for (GLB_ size_t i = 0; i < ot_n; ++i)
+        {
+            GLB_ uint32_t b = static_cast<GLB_ uint32_t>(( i      * in_n) / ot_n);
+            GLB_ uint32_t e = static_cast<GLB_ uint32_t>(((i + 1) * in_n) / ot_n);
+            edge_[i * 2    ] = b;
+            edge_[i * 2 + 1] = (e > b) ? e : (b + 1);
+        }
+    }
+
+    bool valid(void) const { return edge_.data() != NULL; }
+
+    R2Y_FORCE_INLINE_ GLB_ uint32_t begin(GLB_ size_t i) const { return edge_[i * 2    ]; }
+    R2Y_FORCE_INLINE_ GLB_ uint32_t end  (GLB_ size_t i) const { return edge_[i * 2 + 1]; }
+};
+
+/*
+ * Area averaging (a box filter), fed with one source row at a time.
+ * Each source row is binned horizontally into a row of sums once,
+ * and a target row is averaged out as soon as the last source row of its box comes.
+ * The finished target rows are kept in groups, and fetched by (x, y) from there.
+ * Not valid() if out of memory, then it must not be fed.
+ */
+template <typename P>
+class area_scaler
+{
+    R2Y_ detail_scale_::axis_map               x_, y_;
+    GLB_ size_t                                w_, h_, group_;
+    R2Y_ scope_block<R2Y_ detail_scale_::sum3_t> sums_;
+    R2Y_ scope_block<P>                        rows_;  // a group of finished target rows
+    GLB_ size_t                                next_;  // the target row being summed
+    GLB_ size_t                                added_; // source rows summed into it
+
+    void add(P const * row)
+    {
+        for (GLB_ size_t i = 0; i < w_; ++i)
+        {
+            R2Y_ detail_scale_::sum3_t & s = sums_[i];
+            for (GLB_ uint32_t j = x_.begin(i), e = x_.end(i); j < e; ++j)
+            {
+                R2Y_ detail_scale_::accumulate(s, row[j]);
+            }
+        }
+        ++added_;
+    }
+
+    void finish(void)
+    {
+        P * ot_p = rows_.data() + ((next_ % group_) * w_);
+        for (GLB_ size_t i = 0; i < w_; ++i)
+        {
+            R2Y_ detail_scale_::average(sums_[i], (x_.end(i) - x_.begin(i)) * added_, ot_p[i]);
+        }
+        memset(sums_.data(), 0, sums_.size());
+        added_ = 0;
+        ++next_;
+    }
+
+public:
+    /* in_group: how many target rows are walked at once */
+    area_scaler(GLB_ size_t in_w, GLB_ size_t in_h, GLB_ size_t ot_w, GLB_ size_t ot_h, GLB_ size_t in_group)
+        : x_(in_w, ot_w), y_(in_h, ot_h)
+        , w_(ot_w), h_(ot_h), group_(in_group)
+        , sums_(ot_w), rows_(ot_w * in_group)
+        , next_(0), added_(0)
+    {
+        assert((ot_h % in_group) == 0);
+        if (sums_.data() != NULL) memset(sums_.data(), 0, sums_.size());
+    }
+
+    bool valid(void) const
+    {
+        return x_.valid() && y_.valid() && (sums_.data() != NULL) && (rows_.data() != NULL);
+    }
+
+    GLB_ size_t width (void) const { return w_; }
+    GLB_ size_t height(void) const { return h_; }
+    GLB_ size_t done  (void) const { return next_; }
+
+    /*
+     * Feed the source row y (rows come in order).
+     * Returns true as soon as a group of target rows [done() - group, done()) is finished,
+     * then the same row should be fed again, for it may be shared by the next rows when upscaling.
+     */
+    bool feed(P const * row, GLB_ size_t y)
+    {
+        while ((next_ < h_) && (y_.begin(next_) <= y))
+        {
+            if (y_.begin(next_) + added_ == y) this->add(row);
+            if ((y + 1) < y_.end(next_)) break;
+            this->finish();
+            if ((next_ % group_) == 0) return true;
+        }
+        return false;
+    }
+
+    /*
+     * Feed the source row y,
+     * on_rows(y0, y1) is called whenever the target rows [y0, y1) are ready to be walked.
+     */
+    template <typename F>
+    void push(P const * row, GLB_ size_t y, F && on_rows)
+    {
+        while (this->feed(row, y)) on_rows(next_ - group_, next_);
+    }
+
+    R2Y_FORCE_INLINE_ P operator()(GLB_ size_t x, GLB_ size_t y) const
+    {
+        return rows_[((y % group_) * w_) + x];
+    }
+};
+
+/*
+ * Nearest neighbour sampling: the pixel at the middle of each target box, nothing averaged.
+ * Cheaper than area_scaler, for only the sampled source pixels are fetched.
+ * Not valid() if out of memory.
+ */
+template <typename G>
+class nearest_pixels
+{
+    G                              get_;
+    R2Y_ detail_scale_::axis_map x_, y_;
+
+public:
+    nearest_pixels(G && get, GLB_ size_t in_w, GLB_ size_t in_h, GLB_ size_t ot_w, GLB_ size_t ot_h)
+        : get_(STD_ move(get)), x_(in_w, ot_w), y_(in_h, ot_h)
+    {}
+
+    bool valid(void) const { return x_.valid() && y_.valid(); }
+
+    R2Y_FORCE_INLINE_ auto operator()(GLB_ size_t x, GLB_ size_t y) -> decltype(get_(x, y))
+    {
+        return get_((x_.begin(x) + x_.end(x) - 1) >> 1, (y_.begin(y) + y_.end(y) - 1) >> 1);
+    }
+};
+
+} // namespace detail_scale_
+
+/*
+ * A rendition of a ladder: the target size, and the frame to fill
+ * (created by the caller, e.g. with create_buffer<Ot>(w_, h_)).
+ */
+struct rung
+{
+    GLB_ size_t   w_, h_;
+    R2Y_ byte_t * data_;
+};
+
+/*
+ * Scale and convert one source into several renditions in a single pass.
+ * Each source row is read and decoded once into a line shared by all the renditions,
+ * which then bin it into their own sums, so the source is never walked again.
+ * Returns false if out of memory, then no rendition is written.
+ */
+template <R2Y_ supported S, typename Conv>
+bool ladder_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, R2Y_ rung const * rungs, GLB_ size_t count)
+{
+    enum { group = Conv::is_block ? Conv::iterator_size : 1 };
+
+    auto get = R2Y_ detail_walker_::make_pixels<S>(in_data, in_w, in_h, 3);
+    typedef STD_ decay_t<decltype(get(0, 0))>      pixel_t;
+    typedef R2Y_ detail_scale_::area_scaler<pixel_t> scaler_t;
+
+    struct state_t
+    {
+        scaler_t scaler_;
+        Conv     conv_;
+    };
+
+    R2Y_ scope_block<state_t> states{ count };
+    R2Y_ scope_block<pixel_t> line  { in_w };
+    if ((states.data() == NULL) || (line.data() == NULL)) return false;
+
+    bool ok = true;
+    for (GLB_ size_t i = 0; i < count; ++i)
+    {
+        R2Y_ rung const & r = rungs[i];
+        assert(r.data_ != NULL);
+        assert(r.w_ > 0 && r.h_ > 0);
+        assert((r.w_ % Conv::iterator_size) == 0);
+        new (&states[i]) state_t{ scaler_t{ in_w, in_h, r.w_, r.h_, group }, Conv{ r.data_, r.w_, r.h_ } };
+        ok = ok && states[i].scaler_.valid();
+    }
+
+    for (GLB_ size_t y = 0; ok && (y < in_h); ++y)
+    {
+        for (GLB_ size_t x = 0; x < in_w; ++x) line[x] = get(x, y);
+        for (GLB_ size_t i = 0; i < count; ++i)
+        {
+            state_t & st = states[i];
+            st.scaler_.push(line.data(), y, [&st](GLB_ size_t y0, GLB_ size_t y1)
+            {
+                R2Y_ detail_walker_::foreach_rows(st.scaler_.width(), y0, y1, st.scaler_, st.conv_);
+            });
+        }
+    }
+
+    for (GLB_ size_t i = 0; i < count; ++i)
+    {
+        assert(!ok || (states[i].scaler_.done() == rungs[i].h_));
+        states[i].~state_t();
+    }
+    return ok;
+}
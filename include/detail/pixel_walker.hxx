@@ -7,53 +7,93 @@
 /// It's a pixel walker to walk each pixel and execute a closure with it.
 ////////////////////////////////////////////////////////////////
 
-/* 888 */
+namespace detail_walker_ {
 
-template <R2Y_ supported S, typename T, typename F = STD_ remove_reference_t<T>>
-auto pixel_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T && do_sth)
-    -> STD_ enable_if_t<(S == R2Y_ rgb_888 && F::iterator_size == 1 && F::is_block == 0)>
+/*
+ * Walk the rows [in_y0, in_y1) of an image by fetching each pixel with its (x, y),
+ * and pass them to the closure in the shape it asks for.
+ * A run (or a block) sticking out of the right or bottom edge is filled
+ * by replicating the last column (or row) of the range, only the tail pays for it.
+ */
+
+R2Y_FORCE_INLINE_ GLB_ size_t clamp_edge(GLB_ size_t in_i, GLB_ size_t in_n)
 {
-    GLB_ size_t size = calculate_size<S>(in_w, in_h);
-    assert((size % sizeof(R2Y_ rgb_t)) == 0); // 3 input bytes convert to 1 pixel
-    R2Y_ rgb_t * cur_pixel = reinterpret_cast<R2Y_ rgb_t *>(in_data);
-    for (GLB_ size_t i = 0; i < size; i += 3, ++cur_pixel)
+    return (in_i < in_n) ? in_i : (in_n - 1);
+}
+
+template <typename T, typename G, typename F = STD_ remove_reference_t<T>>
+auto foreach_rows(GLB_ size_t in_w, GLB_ size_t in_y0, GLB_ size_t in_y1, G && get, T && do_sth)
+    -> STD_ enable_if_t<(F::iterator_size == 1 && F::is_block == 0 &&
+                         !R2Y_ detail_rows_::takes_rows<F, decltype(get(0, 0))>::value)>
+{
+    for (GLB_ size_t i = in_y0; i < in_y1; ++i)
     {
-        STD_ forward<T>(do_sth)(*cur_pixel);
+        for (GLB_ size_t j = 0; j < in_w; ++j)
+        {
+            STD_ forward<T>(do_sth)(get(j, i));
+        }
     }
 }
 
-template <R2Y_ supported S, typename T, typename F = STD_ remove_reference_t<T>>
-auto pixel_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T && do_sth)
-    -> STD_ enable_if_t<(S == R2Y_ rgb_888 && F::iterator_size > 1 && F::is_block == 0)>
+template <typename T, typename G, typename F = STD_ remove_reference_t<T>>
+auto foreach_rows(GLB_ size_t in_w, GLB_ size_t in_y0, GLB_ size_t in_y1, G && get, T && do_sth)
+    -> STD_ enable_if_t<(F::iterator_size > 1 && F::is_block == 0 &&
+                         !R2Y_ detail_rows_::takes_rows<F, decltype(get(0, 0))>::value)>
 {
-    GLB_ size_t size = calculate_size<S>(in_w, in_h);
-    assert((size % sizeof(R2Y_ rgb_t)) == 0); // 3 input bytes convert to 1 pixel
-    R2Y_ rgb_t * cur_pixel = reinterpret_cast<R2Y_ rgb_t *>(in_data);
-    for (GLB_ size_t i = 0; i < size; i += (3 * F::iterator_size), cur_pixel += F::iterator_size)
+    decltype(get(0, 0)) tmp[F::iterator_size];
+    for (GLB_ size_t i = in_y0; i < in_y1; ++i)
     {
-        STD_ forward<T>(do_sth)(*reinterpret_cast<R2Y_ rgb_t (*)[F::iterator_size]>(& cur_pixel));
+        GLB_ size_t j = 0;
+        for (; (j + F::iterator_size) <= in_w; j += F::iterator_size)
+        {
+            for (int n = 0; n < F::iterator_size; ++n)
+            {
+                tmp[n] = get(j + n, i);
+            }
+            STD_ forward<T>(do_sth)(tmp);
+        }
+        if (j < in_w)
+        {
+            for (int n = 0; n < F::iterator_size; ++n)
+            {
+                tmp[n] = get(R2Y_ detail_walker_::clamp_edge(j + n, in_w), i);
+            }
+            STD_ forward<T>(do_sth)(tmp);
+        }
     }
 }
 
-template <R2Y_ supported S, typename T, typename F = STD_ remove_reference_t<T>>
-auto pixel_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T && do_sth)
-    -> STD_ enable_if_t<(S == R2Y_ rgb_888 && F::iterator_size > 1 && F::is_block == 1)>
-{
-    assert((in_w % F::iterator_size) == 0);
-    assert((in_h % F::iterator_size) == 0);
-    R2Y_ rgb_t tmp[F::iterator_size * F::iterator_size];
-    GLB_ size_t row_offset = in_w - F::iterator_size;
-    R2Y_ rgb_t * cur_pixel = reinterpret_cast<R2Y_ rgb_t *>(in_data);
-    for (GLB_ size_t i = 0; i < in_h; i += F::iterator_size, cur_pixel += (in_w * (F::iterator_size - 1)))
+template <typename T, typename G, typename F = STD_ remove_reference_t<T>>
+auto foreach_rows(GLB_ size_t in_w, GLB_ size_t in_y0, GLB_ size_t in_y1, G && get, T && do_sth)
+    -> STD_ enable_if_t<(F::iterator_size > 1 && F::is_block == 1 &&
+                         !R2Y_ detail_rows_::takes_rows<F, decltype(get(0, 0))>::value)>
+{
+    decltype(get(0, 0)) tmp[F::iterator_size * F::iterator_size];
+    for (GLB_ size_t i = in_y0; i < in_y1; i += F::iterator_size)
     {
-        for (GLB_ size_t j = 0; j < in_w; j += F::iterator_size, cur_pixel += F::iterator_size)
+        GLB_ size_t j = 0;
+        if ((i + F::iterator_size) <= in_y1)
+        {
+            for (; (j + F::iterator_size) <= in_w; j += F::iterator_size)
+            {
+                for (int n = 0, index = 0; n < F::iterator_size; ++n)
+                {
+                    for (int m = 0; m < F::iterator_size; ++m, ++index)
+                    {
+                        tmp[index] = get(j + m, i + n);
+                    }
+                }
+                STD_ forward<T>(do_sth)(tmp);
+            }
+        }
+        for (; j < in_w; j += F::iterator_size)
         {
-            R2Y_ rgb_t * block_iter = cur_pixel;
-            for (int n = 0, index = 0; n < F::iterator_size; ++n, block_iter += row_offset)
+            for (int n = 0, index = 0; n < F::iterator_size; ++n)
             {
-                for (int m = 0; m < F::iterator_size; ++m, ++index, ++block_iter)
+                for (int m = 0; m < F::iterator_size; ++m, ++index)
                 {
-                    tmp[index] = *block_iter;
+                    tmp[index] = get(R2Y_ detail_walker_::clamp_edge(j + m, in_w),
+                                     R2Y_ detail_walker_::clamp_edge(i + n, in_y1));
                 }
             }
             STD_ forward<T>(do_sth)(tmp);
@@ -61,405 +101,651 @@ auto pixel_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T
     }
 }
 
-/* 565 */
-
-template <R2Y_ supported S, typename T, typename F = STD_ remove_reference_t<T>>
-auto pixel_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T && do_sth)
-    -> STD_ enable_if_t<(S == R2Y_ rgb_565 && F::iterator_size == 1 && F::is_block == 0)>
+/*
+ * Planar rows, for the closures taking them (see detail_rows_):
+ * each band of rows is cut into runs of whole steps, and each run is fetched into its planes.
+ */
+template <typename T, typename G, typename F = STD_ remove_reference_t<T>>
+auto foreach_rows(GLB_ size_t in_w, GLB_ size_t in_y0, GLB_ size_t in_y1, G && get, T && do_sth)
+    -> STD_ enable_if_t<R2Y_ detail_rows_::takes_rows<F, decltype(get(0, 0))>::value>
 {
-    GLB_ size_t size = calculate_size<S>(in_w, in_h);
-    assert((size & 1) == 0); // in_size must be an even number
-    R2Y_ rgb_t tmp;
-    GLB_ uint16_t * cur_pixel = reinterpret_cast<GLB_ uint16_t *>(in_data);
-    for (GLB_ size_t i = 0; i < size; i += 2, ++cur_pixel)
+    enum { K = F::iterator_size, R = F::is_block ? F::iterator_size : 1 };
+    R2Y_ detail_rows_::planar_rows<decltype(get(0, 0)), R> tmp;
+    static_assert((decltype(tmp)::size % K) == 0, "The rows must hold whole steps.");
+    for (GLB_ size_t i = in_y0; i < in_y1; i += R)
     {
-        tmp.r_ = static_cast<GLB_ uint8_t>( ((*cur_pixel) & 0xF800) >> 8 );
-        tmp.g_ = static_cast<GLB_ uint8_t>( ((*cur_pixel) & 0x07E0) >> 3 );
-        tmp.b_ = static_cast<GLB_ uint8_t>( ((*cur_pixel) & 0x001F) << 3 );
-        STD_ forward<T>(do_sth)(tmp);
+        for (GLB_ size_t j = 0; j < in_w; j += decltype(tmp)::size)
+        {
+            GLB_ size_t n = ((in_w - j) < decltype(tmp)::size) ? (in_w - j) : decltype(tmp)::size;
+            GLB_ size_t c = ((n + K - 1) / K) * K;
+            for (int r = 0; r < R; ++r)
+            {
+                GLB_ size_t y = R2Y_ detail_walker_::clamp_edge(i + r, in_y1);
+                GLB_ size_t m = 0;
+                for (; m < n; ++m) R2Y_ detail_rows_::put(tmp, r, m, get(j + m, y));
+                for (; m < c; ++m) R2Y_ detail_rows_::put(tmp, r, m, get(in_w - 1, y));
+            }
+            STD_ forward<T>(do_sth)(tmp, c);
+        }
     }
 }
 
-template <R2Y_ supported S, typename T, typename F = STD_ remove_reference_t<T>>
-auto pixel_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T && do_sth)
-    -> STD_ enable_if_t<(S == R2Y_ rgb_565 && F::iterator_size > 1 && F::is_block == 0)>
+/* The whole image */
+
+template <typename T, typename G>
+void foreach_xy(GLB_ size_t in_w, GLB_ size_t in_h, G && get, T && do_sth)
+{
+    R2Y_ detail_walker_::foreach_rows(in_w, 0, in_h, STD_ forward<G>(get), STD_ forward<T>(do_sth));
+}
+
+/* Pixels stored one by one */
+
+template <typename P>
+struct plain_pixels
 {
-    GLB_ size_t size = calculate_size<S>(in_w, in_h);
-    assert((size & 1) == 0); // in_size must be an even number
-    R2Y_ rgb_t tmp[F::iterator_size];
-    GLB_ uint16_t * cur_pixel = reinterpret_cast<GLB_ uint16_t *>(in_data);
-    for (GLB_ size_t i = 0; i < size; i += (2 * F::iterator_size))
+    P const *   data_;
+    GLB_ size_t w_, pitch_; // pitch_: the bytes from a row to the next
+
+    plain_pixels(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_pitch)
+        : data_(reinterpret_cast<P const *>(in_data)), w_(in_w), pitch_(in_pitch)
+    {}
+
+    plain_pixels(R2Y_ byte_t * in_data, GLB_ size_t in_w)
+        : plain_pixels(in_data, in_w, in_w * sizeof(P))
+    {}
+
+    R2Y_FORCE_INLINE_ P const * row(GLB_ size_t y) const
     {
-        for (int n = 0; n < F::iterator_size; ++n, ++cur_pixel)
-        {
-            R2Y_ rgb_t & ref = tmp[n];
-            ref.r_ = static_cast<GLB_ uint8_t>( ((*cur_pixel) & 0xF800) >> 8 );
-            ref.g_ = static_cast<GLB_ uint8_t>( ((*cur_pixel) & 0x07E0) >> 3 );
-            ref.b_ = static_cast<GLB_ uint8_t>( ((*cur_pixel) & 0x001F) << 3 );
-        }
-        STD_ forward<T>(do_sth)(tmp);
+        return reinterpret_cast<P const *>(reinterpret_cast<R2Y_ byte_t const *>(data_) + (y * pitch_));
     }
-}
 
-template <R2Y_ supported S, typename T, typename F = STD_ remove_reference_t<T>>
-auto pixel_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T && do_sth)
-    -> STD_ enable_if_t<(S == R2Y_ rgb_565 && F::iterator_size > 1 && F::is_block == 1)>
-{
-    assert((in_w % F::iterator_size) == 0);
-    assert((in_h % F::iterator_size) == 0);
-    R2Y_ rgb_t tmp[F::iterator_size * F::iterator_size];
-    GLB_ size_t row_offset = in_w - F::iterator_size;
-    GLB_ uint16_t * cur_pixel = reinterpret_cast<GLB_ uint16_t *>(in_data);
-    for (GLB_ size_t i = 0; i < in_h; i += F::iterator_size, cur_pixel += (in_w * (F::iterator_size - 1)))
+    R2Y_FORCE_INLINE_ P operator()(GLB_ size_t x, GLB_ size_t y) const
     {
-        for (GLB_ size_t j = 0; j < in_w; j += F::iterator_size, cur_pixel += F::iterator_size)
-        {
-            GLB_ uint16_t * block_iter = cur_pixel;
-            for (int n = 0, index = 0; n < F::iterator_size; ++n, block_iter += row_offset)
-            {
-                for (int m = 0; m < F::iterator_size; ++m, ++index, ++block_iter)
-                {
-                    R2Y_ rgb_t & ref = tmp[index];
-                    ref.r_ = static_cast<GLB_ uint8_t>( ((*block_iter) & 0xF800) >> 8 );
-                    ref.g_ = static_cast<GLB_ uint8_t>( ((*block_iter) & 0x07E0) >> 3 );
-                    ref.b_ = static_cast<GLB_ uint8_t>( ((*block_iter) & 0x001F) << 3 );
-                }
-            }
-            STD_ forward<T>(do_sth)(tmp);
-        }
+        return this->row(y)[x];
     }
-}
+};
 
-/* 555 */
+/* Packed RGB pixels, decoded one by one */
 
-template <R2Y_ supported S, typename T, typename F = STD_ remove_reference_t<T>>
-auto pixel_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T && do_sth)
-    -> STD_ enable_if_t<(S == R2Y_ rgb_555 && F::iterator_size == 1 && F::is_block == 0)>
+template <R2Y_ supported S> struct rgb_pixels;
+
+template <> struct rgb_pixels<R2Y_ rgb_888X> : R2Y_ detail_walker_::plain_pixels<GLB_ uint32_t>
 {
-    GLB_ size_t size = calculate_size<S>(in_w, in_h);
-    assert((size & 1) == 0); // in_size must be an even number
-    R2Y_ rgb_t tmp;
-    GLB_ uint16_t * cur_pixel = reinterpret_cast<GLB_ uint16_t *>(in_data);
-    for (GLB_ size_t i = 0; i < size; i += 2, ++cur_pixel)
+    using plain_pixels::plain_pixels;
+
+    R2Y_FORCE_INLINE_ R2Y_ rgb_t operator()(GLB_ size_t x, GLB_ size_t y) const
     {
-        tmp.r_ = static_cast<GLB_ uint8_t>( ((*cur_pixel) & 0x7C00) >> 7 );
-        tmp.g_ = static_cast<GLB_ uint8_t>( ((*cur_pixel) & 0x03E0) >> 2 );
-        tmp.b_ = static_cast<GLB_ uint8_t>( ((*cur_pixel) & 0x001F) << 3 );
-        STD_ forward<T>(do_sth)(tmp);
+        return *reinterpret_cast<R2Y_ rgb_t const *>(this->row(y) + x);
     }
-}
+};
 
-template <R2Y_ supported S, typename T, typename F = STD_ remove_reference_t<T>>
-auto pixel_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T && do_sth)
-    -> STD_ enable_if_t<(S == R2Y_ rgb_555 && F::iterator_size > 1 && F::is_block == 0)>
+template <> struct rgb_pixels<R2Y_ rgb_565> : R2Y_ detail_walker_::plain_pixels<GLB_ uint16_t>
+{
+    using plain_pixels::plain_pixels;
+
+    R2Y_FORCE_INLINE_ R2Y_ rgb_t operator()(GLB_ size_t x, GLB_ size_t y) const
+    {
+        GLB_ uint16_t pix = this->row(y)[x];
+        R2Y_ rgb_t ret;
+        ret.r_ = static_cast<GLB_ uint8_t>( (pix & 0xF800) >> 8 );
+        ret.g_ = static_cast<GLB_ uint8_t>( (pix & 0x07E0) >> 3 );
+        ret.b_ = static_cast<GLB_ uint8_t>( (pix & 0x001F) << 3 );
+        return ret;
+    }
+};
+
+template <> struct rgb_pixels<R2Y_ rgb_555> : R2Y_ detail_walker_::plain_pixels<GLB_ uint16_t>
 {
-    GLB_ size_t size = calculate_size<S>(in_w, in_h);
-    assert((size & 1) == 0); // in_size must be an even number
-    R2Y_ rgb_t tmp[F::iterator_size];
-    GLB_ uint16_t * cur_pixel = reinterpret_cast<GLB_ uint16_t *>(in_data);
-    for (GLB_ size_t i = 0; i < size; i += (2 * F::iterator_size))
+    using plain_pixels::plain_pixels;
+
+    R2Y_FORCE_INLINE_ R2Y_ rgb_t operator()(GLB_ size_t x, GLB_ size_t y) const
+    {
+        GLB_ uint16_t pix = this->row(y)[x];
+        R2Y_ rgb_t ret;
+        ret.r_ = static_cast<GLB_ uint8_t>( (pix & 0x7C00) >> 7 );
+        ret.g_ = static_cast<GLB_ uint8_t>( (pix & 0x03E0) >> 2 );
+        ret.b_ = static_cast<GLB_ uint8_t>( (pix & 0x001F) << 3 );
+        return ret;
+    }
+};
+
+/* 3 bytes for 2 pixels, the rows run on without a pitch */
+template <> struct rgb_pixels<R2Y_ rgb_444> : R2Y_ detail_walker_::plain_pixels<GLB_ uint8_t>
+{
+    using plain_pixels::plain_pixels;
+
+    R2Y_FORCE_INLINE_ R2Y_ rgb_t operator()(GLB_ size_t x, GLB_ size_t y) const
     {
-        for (int n = 0; n < F::iterator_size; ++n, ++cur_pixel)
+        GLB_ size_t i = y * w_ + x;
+        GLB_ uint8_t const * pix = data_ + ((i >> 1) * 3);
+        R2Y_ rgb_t ret;
+        if ((i & 1) == 0)
         {
-            R2Y_ rgb_t & ref = tmp[n];
-            ref.r_ = static_cast<GLB_ uint8_t>( ((*cur_pixel) & 0x7C00) >> 7 );
-            ref.g_ = static_cast<GLB_ uint8_t>( ((*cur_pixel) & 0x03E0) >> 2 );
-            ref.b_ = static_cast<GLB_ uint8_t>( ((*cur_pixel) & 0x001F) << 3 );
+            ret.b_ = static_cast<GLB_ uint8_t>( (pix[0] & 0x0F) << 4 );
+            ret.g_ = static_cast<GLB_ uint8_t>  (pix[0] & 0xF0);
+            ret.r_ = static_cast<GLB_ uint8_t>( (pix[1] & 0x0F) << 4 );
         }
-        STD_ forward<T>(do_sth)(tmp);
+        else
+        {
+            ret.b_ = static_cast<GLB_ uint8_t>  (pix[1] & 0xF0);
+            ret.g_ = static_cast<GLB_ uint8_t>( (pix[2] & 0x0F) << 4 );
+            ret.r_ = static_cast<GLB_ uint8_t>  (pix[2] & 0xF0);
+        }
+        return ret;
     }
-}
+};
 
-template <R2Y_ supported S, typename T, typename F = STD_ remove_reference_t<T>>
-auto pixel_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T && do_sth)
-    -> STD_ enable_if_t<(S == R2Y_ rgb_555 && F::iterator_size > 1 && F::is_block == 1)>
-{
-    assert((in_w % F::iterator_size) == 0);
-    assert((in_h % F::iterator_size) == 0);
-    R2Y_ rgb_t tmp[F::iterator_size * F::iterator_size];
-    GLB_ size_t row_offset = in_w - F::iterator_size;
-    GLB_ uint16_t * cur_pixel = reinterpret_cast<GLB_ uint16_t *>(in_data);
-    for (GLB_ size_t i = 0; i < in_h; i += F::iterator_size, cur_pixel += (in_w * (F::iterator_size - 1)))
+/* YCoCg/YCoCg-R/RCT/ICT planes, transformed back to RGB */
+
+template <R2Y_ supported S>
+struct ycc_pixels
+{
+    typedef R2Y_ detail_ycc_::color_transform<S> transform_t;
+    typedef typename transform_t::sample_t       sample_t;
+
+    sample_t const * c0_, * c1_, * c2_;
+    GLB_ size_t      w_;
+
+    ycc_pixels(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h)
+        : c0_(reinterpret_cast<sample_t const *>(in_data))
+        , c1_(c0_ + (in_w * in_h)), c2_(c1_ + (in_w * in_h)), w_(in_w)
+    {}
+
+    R2Y_FORCE_INLINE_ R2Y_ rgb_t operator()(GLB_ size_t x, GLB_ size_t y) const
+    {
+        GLB_ size_t i = y * w_ + x;
+        return transform_t::inverse(c0_[i], c1_[i], c2_[i]);
+    }
+};
+
+/* Luma only, with neutral chroma */
+
+struct luma_pixels : R2Y_ detail_walker_::plain_pixels<R2Y_ byte_t>
+{
+    using plain_pixels::plain_pixels;
+
+    R2Y_FORCE_INLINE_ R2Y_ yuv_t operator()(GLB_ size_t x, GLB_ size_t y) const
+    {
+        return { 128, 128, this->row(y)[x] };
+    }
+};
+
+/* 4:2:0 10-bit, Y plane followed by the combined CbCr plane */
+
+struct p010_pixels
+{
+    GLB_ uint16_t const * y_, * uv_;
+    GLB_ size_t           w_, uv_w_; // uv_w_: the words of a chroma row, rounded up
+
+    p010_pixels(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h)
+        : y_(reinterpret_cast<GLB_ uint16_t const *>(in_data))
+        , uv_(y_ + (in_w * in_h)), w_(in_w), uv_w_(((in_w + 1) >> 1) << 1)
+    {}
+
+    R2Y_FORCE_INLINE_ R2Y_ yuv16_t operator()(GLB_ size_t x, GLB_ size_t y) const
     {
-        for (GLB_ size_t j = 0; j < in_w; j += F::iterator_size, cur_pixel += F::iterator_size)
+        GLB_ uint16_t const * uv = uv_ + ((y >> 1) * uv_w_) + (x & ~static_cast<GLB_ size_t>(1));
+        return
         {
-            GLB_ uint16_t * block_iter = cur_pixel;
-            for (int n = 0, index = 0; n < F::iterator_size; ++n, block_iter += row_offset)
-            {
-                for (int m = 0; m < F::iterator_size; ++m, ++index, ++block_iter)
-                {
-                    R2Y_ rgb_t & ref = tmp[index];
-                    ref.r_ = static_cast<GLB_ uint8_t>( ((*block_iter) & 0x7C00) >> 7 );
-                    ref.g_ = static_cast<GLB_ uint8_t>( ((*block_iter) & 0x03E0) >> 2 );
-                    ref.b_ = static_cast<GLB_ uint8_t>( ((*block_iter) & 0x001F) << 3 );
-                }
-            }
-            STD_ forward<T>(do_sth)(tmp);
-        }
+            static_cast<GLB_ uint16_t>(uv[1] >> 6),
+            static_cast<GLB_ uint16_t>(uv[0] >> 6),
+            static_cast<GLB_ uint16_t>(y_[y * w_ + x] >> 6)
+        };
     }
-}
+};
 
-/* 444 */
+#pragma push_macro("R2Y_HELPER_")
+#undef  R2Y_HELPER_
+#define R2Y_HELPER_ R2Y_ detail_helper_::
 
-template <R2Y_ supported S, typename T, typename F = STD_ remove_reference_t<T>>
-auto pixel_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T && do_sth)
-    -> STD_ enable_if_t<(S == R2Y_ rgb_444 && F::iterator_size == 1 && F::is_block == 0)>
+/* YUYV/YVYU/UYVY/VYUY, each row padded to whole macro pixels */
+
+template <R2Y_ supported S>
+struct packed_422_pixels : R2Y_ detail_walker_::plain_pixels<R2Y_HELPER_ packed_yuv_t<S>>
+{
+    packed_422_pixels(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_pitch)
+        : R2Y_ detail_walker_::plain_pixels<R2Y_HELPER_ packed_yuv_t<S>>(in_data, (in_w + 1) >> 1, in_pitch)
+    {}
+
+    packed_422_pixels(R2Y_ byte_t * in_data, GLB_ size_t in_w)
+        : R2Y_ detail_walker_::plain_pixels<R2Y_HELPER_ packed_yuv_t<S>>(in_data, (in_w + 1) >> 1)
+    {}
+
+    R2Y_FORCE_INLINE_ R2Y_ yuv_t operator()(GLB_ size_t x, GLB_ size_t y) const
+    {
+        R2Y_HELPER_ packed_yuv_t<S> const & pix = this->row(y)[x >> 1];
+        return { pix.cr_, pix.cb_, (x & 1) ? pix.y1_ : pix.y0_ };
+    }
+};
+
+/* Y41P, 8 pixels in 12 bytes */
+
+struct y41p_pixels : R2Y_ detail_walker_::plain_pixels<R2Y_HELPER_ packed_yuv_t<R2Y_ yuv_Y41P>>
+{
+    y41p_pixels(R2Y_ byte_t * in_data, GLB_ size_t in_w)
+        : plain_pixels(in_data, (in_w + 7) >> 3)
+    {}
+
+    R2Y_FORCE_INLINE_ R2Y_ yuv_t operator()(GLB_ size_t x, GLB_ size_t y) const
+    {
+        static GLB_ uint8_t const luma[] = { 1, 3, 5, 7, 8, 9, 10, 11 };
+        R2Y_HELPER_ packed_yuv_t<R2Y_ yuv_Y41P> const & pix = this->row(y)[x >> 3];
+        GLB_ uint8_t l = reinterpret_cast<GLB_ uint8_t const *>(&pix)[luma[x & 7]];
+        return ((x & 7) < 4) ? R2Y_ yuv_t{ pix.v0_, pix.u0_, l } : R2Y_ yuv_t{ pix.v1_, pix.u1_, l };
+    }
+};
+
+/* Y411, 4 pixels in 6 bytes */
+
+struct y411_pixels : R2Y_ detail_walker_::plain_pixels<R2Y_HELPER_ packed_yuv_t<R2Y_ yuv_Y411>>
+{
+    y411_pixels(R2Y_ byte_t * in_data, GLB_ size_t in_w)
+        : plain_pixels(in_data, (in_w + 3) >> 2)
+    {}
+
+    R2Y_FORCE_INLINE_ R2Y_ yuv_t operator()(GLB_ size_t x, GLB_ size_t y) const
+    {
+        static GLB_ uint8_t const luma[] = { 1, 2, 4, 5 };
+        R2Y_HELPER_ packed_yuv_t<R2Y_ yuv_Y411> const & pix = this->row(y)[x >> 2];
+        return { pix.cr_, pix.cb_, reinterpret_cast<GLB_ uint8_t const *>(&pix)[luma[x & 3]] };
+    }
+};
+
+/* Planar, the chroma of (x, y) is shared by its subsampled block */
+
+template <R2Y_ supported S>
+struct planar_pixels
 {
-    GLB_ size_t size = calculate_size<S>(in_w, in_h);
-    assert((size % 3) == 0); // 3 input bytes convert to 2 pixels (6 bytes)
-    R2Y_ rgb_t tmp;
-    for (GLB_ size_t i = 0; i < size; i += 3)
+    typedef R2Y_HELPER_ chroma_sub<S> sub_t;
+
+    R2Y_ frame_planes f_;
+
+    planar_pixels(R2Y_ frame_planes const & in_f)
+        : f_(in_f)
+    {}
+
+    planar_pixels(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h)
+        : f_(R2Y_ detail_layout_::tight_planes<S>(in_data, in_w, in_h))
+    {}
+
+    R2Y_FORCE_INLINE_ R2Y_ yuv_t operator()(GLB_ size_t x, GLB_ size_t y) const
     {
-        tmp.b_ = static_cast<GLB_ uint8_t>( ((*in_data) & 0x0F) << 4 );
-        tmp.g_ = static_cast<GLB_ uint8_t>  ((*in_data) & 0xF0);        ++in_data;
-        tmp.r_ = static_cast<GLB_ uint8_t>( ((*in_data) & 0x0F) << 4 );
-        STD_ forward<T>(do_sth)(tmp);
-        tmp.b_ = static_cast<GLB_ uint8_t>  ((*in_data) & 0xF0);        ++in_data;
-        tmp.g_ = static_cast<GLB_ uint8_t>( ((*in_data) & 0x0F) << 4 );
-        tmp.r_ = static_cast<GLB_ uint8_t>  ((*in_data) & 0xF0);        ++in_data;
-        STD_ forward<T>(do_sth)(tmp);
+        R2Y_ yuv_t ret;
+        R2Y_HELPER_ get_planar_uv(ret.u_, ret.v_, R2Y_HELPER_ planar_uv_at<S>(f_, y / sub_t::y), x / sub_t::x);
+        ret.y_ = f_.data_[0][(y * f_.pitch_[0]) + x];
+        return ret;
     }
+};
+
+#pragma pop_macro("R2Y_HELPER_")
+
+
+/*
+ * The fetcher of each format which can be walked by (x, y).
+ * in_rows: how many consecutive rows a walk step may touch.
+ */
+
+template <R2Y_ supported S>
+auto make_pixels(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t /*in_h*/, GLB_ size_t /*in_rows*/)
+    -> STD_ enable_if_t<(S == R2Y_ rgb_888), R2Y_ detail_walker_::plain_pixels<R2Y_ rgb_t>>
+{
+    return { in_data, in_w };
 }
 
-template <R2Y_ supported S, typename T, typename F = STD_ remove_reference_t<T>>
-auto pixel_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T && do_sth)
-    -> STD_ enable_if_t<(S == R2Y_ rgb_444 && F::iterator_size > 1 && (F::iterator_size & 1) == 0 && F::is_block == 0)>
+template <R2Y_ supported S>
+auto make_pixels(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t /*in_h*/, GLB_ size_t /*in_rows*/)
+    -> STD_ enable_if_t<(S == R2Y_ rgb_888X || S == R2Y_ rgb_565 ||
+                         S == R2Y_ rgb_555  || S == R2Y_ rgb_444), R2Y_ detail_walker_::rgb_pixels<S>>
+{
+    return { in_data, in_w };
+}
+
+template <R2Y_ supported S>
+auto make_pixels(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t /*in_h*/, GLB_ size_t /*in_rows*/)
+    -> STD_ enable_if_t<(S == R2Y_ idx_8), R2Y_ detail_walker_::plain_pixels<R2Y_ byte_t>>
+{
+    return { in_data, in_w };
+}
+
+template <R2Y_ supported S>
+auto make_pixels(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, GLB_ size_t in_rows)
+    -> STD_ enable_if_t<(S == R2Y_ bayer_RGGB || S == R2Y_ bayer_BGGR ||
+                         S == R2Y_ bayer_GRBG || S == R2Y_ bayer_GBRG),
+                        R2Y_ detail_bayer_::demosaic<S, R2Y_ detail_bayer_::plain_rows<R2Y_ byte_t>>>
+{
+    return { in_data, in_w, in_h, in_rows };
+}
+
+template <R2Y_ supported S>
+auto make_pixels(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, GLB_ size_t in_rows)
+    -> STD_ enable_if_t<(S == R2Y_ bayer_RGGB10 || S == R2Y_ bayer_BGGR10 ||
+                         S == R2Y_ bayer_GRBG10 || S == R2Y_ bayer_GBRG10),
+                        R2Y_ detail_bayer_::demosaic<S, R2Y_ detail_bayer_::packed_rows<10>>>
+{
+    return { in_data, in_w, in_h, in_rows };
+}
+
+template <R2Y_ supported S>
+auto make_pixels(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, GLB_ size_t in_rows)
+    -> STD_ enable_if_t<(S == R2Y_ bayer_RGGB12 || S == R2Y_ bayer_BGGR12 ||
+                         S == R2Y_ bayer_GRBG12 || S == R2Y_ bayer_GBRG12),
+                        R2Y_ detail_bayer_::demosaic<S, R2Y_ detail_bayer_::packed_rows<12>>>
+{
+    return { in_data, in_w, in_h, in_rows };
+}
+
+template <R2Y_ supported S>
+auto make_pixels(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, GLB_ size_t /*in_rows*/)
+    -> STD_ enable_if_t<R2Y_ is_ycc<S>::value, R2Y_ detail_walker_::ycc_pixels<S>>
+{
+    return { in_data, in_w, in_h };
+}
+
+template <R2Y_ supported S>
+auto make_pixels(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t /*in_h*/, GLB_ size_t /*in_rows*/)
+    -> STD_ enable_if_t<(S == R2Y_ yuv_YUYV || S == R2Y_ yuv_YVYU ||
+                         S == R2Y_ yuv_UYVY || S == R2Y_ yuv_VYUY), R2Y_ detail_walker_::packed_422_pixels<S>>
+{
+    return { in_data, in_w };
+}
+
+template <R2Y_ supported S>
+auto make_pixels(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t /*in_h*/, GLB_ size_t /*in_rows*/)
+    -> STD_ enable_if_t<(S == R2Y_ yuv_Y41P), R2Y_ detail_walker_::y41p_pixels>
+{
+    return { in_data, in_w };
+}
+
+template <R2Y_ supported S>
+auto make_pixels(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t /*in_h*/, GLB_ size_t /*in_rows*/)
+    -> STD_ enable_if_t<(S == R2Y_ yuv_Y411), R2Y_ detail_walker_::y411_pixels>
+{
+    return { in_data, in_w };
+}
+
+template <R2Y_ supported S>
+auto make_pixels(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, GLB_ size_t /*in_rows*/)
+    -> STD_ enable_if_t<(S == R2Y_ yuv_NV24 || S == R2Y_ yuv_NV42 ||
+                         S == R2Y_ yuv_YV12 || S == R2Y_ yuv_YU12 ||
+                         S == R2Y_ yuv_NV12 || S == R2Y_ yuv_NV21), R2Y_ detail_walker_::planar_pixels<S>>
+{
+    return { in_data, in_w, in_h };
+}
+
+template <R2Y_ supported S>
+auto make_pixels(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t /*in_h*/, GLB_ size_t /*in_rows*/)
+    -> STD_ enable_if_t<(S == R2Y_ yuv_Y800), R2Y_ detail_walker_::luma_pixels>
 {
-    GLB_ size_t size = calculate_size<S>(in_w, in_h);
-    assert((size % 3) == 0); // 3 input bytes convert to 2 pixels (6 bytes)
-    R2Y_ rgb_t tmp[F::iterator_size];
-    for (GLB_ size_t i = 0; i < size; i += (3 * (F::iterator_size >> 1)))
+    return { in_data, in_w };
+}
+
+/* The same, over planes of any pitch (only the formats of the C interface) */
+
+template <R2Y_ supported S>
+auto make_pixels(R2Y_ frame_planes const & in_f, GLB_ size_t in_w, GLB_ size_t /*in_h*/, GLB_ size_t /*in_rows*/)
+    -> STD_ enable_if_t<(S == R2Y_ rgb_888), R2Y_ detail_walker_::plain_pixels<R2Y_ rgb_t>>
+{
+    return { in_f.data_[0], in_w, in_f.pitch_[0] };
+}
+
+template <R2Y_ supported S>
+auto make_pixels(R2Y_ frame_planes const & in_f, GLB_ size_t in_w, GLB_ size_t /*in_h*/, GLB_ size_t /*in_rows*/)
+    -> STD_ enable_if_t<(S == R2Y_ rgb_888X || S == R2Y_ rgb_565 || S == R2Y_ rgb_555), R2Y_ detail_walker_::rgb_pixels<S>>
+{
+    return { in_f.data_[0], in_w, in_f.pitch_[0] };
+}
+
+template <R2Y_ supported S>
+auto make_pixels(R2Y_ frame_planes const & in_f, GLB_ size_t in_w, GLB_ size_t /*in_h*/, GLB_ size_t /*in_rows*/)
+    -> STD_ enable_if_t<(S == R2Y_ yuv_YUYV || S == R2Y_ yuv_YVYU ||
+                         S == R2Y_ yuv_UYVY || S == R2Y_ yuv_VYUY), R2Y_ detail_walker_::packed_422_pixels<S>>
+{
+    return { in_f.data_[0], in_w, in_f.pitch_[0] };
+}
+
+template <R2Y_ supported S>
+auto make_pixels(R2Y_ frame_planes const & in_f, GLB_ size_t in_w, GLB_ size_t /*in_h*/, GLB_ size_t /*in_rows*/)
+    -> STD_ enable_if_t<(S == R2Y_ yuv_Y800), R2Y_ detail_walker_::luma_pixels>
+{
+    return { in_f.data_[0], in_w, in_f.pitch_[0] };
+}
+
+template <R2Y_ supported S>
+auto make_pixels(R2Y_ frame_planes const & in_f, GLB_ size_t /*in_w*/, GLB_ size_t /*in_h*/, GLB_ size_t /*in_rows*/)
+    -> STD_ enable_if_t<(S == R2Y_ yuv_NV24 || S == R2Y_ yuv_NV42 ||
+                         S == R2Y_ yuv_YV12 || S == R2Y_ yuv_YU12 ||
+                         S == R2Y_ yuv_NV12 || S == R2Y_ yuv_NV21), R2Y_ detail_walker_::planar_pixels<S>>
+{
+    return { in_f };
+}
+
+/*
+ * Walk only the pixels selected by a mask, in the shape the closure asks for.
+ * The mask is tested a chunk at a time: unselected chunks are skipped in the output
+ * without fetching or converting anything, fully selected chunks are converted as usual,
+ * and only the partially selected ones go pixel by pixel (or block by block), blended.
+ */
+
+template <typename T, typename G>
+R2Y_FORCE_INLINE_ void masked_pixel(GLB_ size_t x, GLB_ size_t y, G && get, R2Y_ detail_mask_::mask_reader const & mask, T && do_sth)
+{
+    R2Y_ byte_t a = mask.alpha(x, y);
+    if      (a == 0)    do_sth.skip(1);
+    else if (a == 0xFF) STD_ forward<T>(do_sth)(get(x, y));
+    else                STD_ forward<T>(do_sth)(get(x, y), a);
+}
+
+template <typename T, typename G, typename F = STD_ remove_reference_t<T>>
+auto foreach_masked(GLB_ size_t in_w, GLB_ size_t in_h, G && get, R2Y_ detail_mask_::mask_reader const & mask, T && do_sth)
+    -> STD_ enable_if_t<(F::iterator_size == 1 && F::is_block == 0)>
+{
+    enum { C = R2Y_ detail_mask_::mask_reader::chunk_size };
+    for (GLB_ size_t i = 0; i < in_h; ++i)
     {
-        for (int n = 0; n < F::iterator_size;)
+        GLB_ size_t j = 0;
+        for (; (j + C) <= in_w; j += C)
         {
+            switch (mask.chunk(j, i))
             {
-                R2Y_ rgb_t & ref = tmp[n]; ++n;
-                ref.b_ = static_cast<GLB_ uint8_t>( ((*in_data) & 0x0F) << 4 );
-                ref.g_ = static_cast<GLB_ uint8_t>  ((*in_data) & 0xF0); ++in_data;
-                ref.r_ = static_cast<GLB_ uint8_t>( ((*in_data) & 0x0F) << 4 );
-            }
-            {
-                R2Y_ rgb_t & ref = tmp[n]; ++n;
-                ref.b_ = static_cast<GLB_ uint8_t>  ((*in_data) & 0xF0); ++in_data;
-                ref.g_ = static_cast<GLB_ uint8_t>( ((*in_data) & 0x0F) << 4 );
-                ref.r_ = static_cast<GLB_ uint8_t>  ((*in_data) & 0xF0); ++in_data;
+            case R2Y_ detail_mask_::cover_NONE:
+                do_sth.skip(C);
+                break;
+            case R2Y_ detail_mask_::cover_FULL:
+                for (GLB_ size_t k = 0; k < C; ++k) STD_ forward<T>(do_sth)(get(j + k, i));
+                break;
+            default:
+                for (GLB_ size_t k = 0; k < C; ++k) R2Y_ detail_walker_::masked_pixel(j + k, i, get, mask, do_sth);
+                break;
             }
         }
-        STD_ forward<T>(do_sth)(tmp);
+        for (; j < in_w; ++j) R2Y_ detail_walker_::masked_pixel(j, i, get, mask, do_sth);
     }
 }
 
-template <R2Y_ supported S, typename T, typename F = STD_ remove_reference_t<T>>
-auto pixel_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T && do_sth)
-    -> STD_ enable_if_t<(S == R2Y_ rgb_444 && F::iterator_size > 1 && (F::iterator_size & 1) == 0 && F::is_block == 1)>
+template <typename T, typename G, typename F = STD_ remove_reference_t<T>>
+auto foreach_masked(GLB_ size_t in_w, GLB_ size_t in_h, G && get, R2Y_ detail_mask_::mask_reader const & mask, T && do_sth)
+    -> STD_ enable_if_t<(F::iterator_size > 1 && F::is_block == 1)>
 {
-    assert((in_w % F::iterator_size) == 0);
-    assert((in_h % F::iterator_size) == 0);
-    R2Y_ rgb_t tmp[F::iterator_size * F::iterator_size];
-    GLB_ size_t row_offset = ((in_w - F::iterator_size) >> 1) * 3;
-    for (GLB_ size_t i = 0; i < in_h; i += F::iterator_size, in_data += (in_w * (((F::iterator_size - 1) * 3) >> 1)))
+    enum
     {
-        for (GLB_ size_t j = 0; j < in_w; j += F::iterator_size, in_data += (3 * (F::iterator_size >> 1)))
+        N = F::iterator_size,
+        C = R2Y_ detail_mask_::mask_reader::chunk_size
+    };
+    static_assert((C % N) == 0, "A chunk must hold whole blocks.");
+    assert((in_w % N) == 0);
+    assert((in_h % N) == 0);
+    decltype(get(0, 0)) tmp[N * N];
+    R2Y_ byte_t         alpha[N * N];
+    for (GLB_ size_t i = 0; i < in_h; i += N)
+    {
+        for (GLB_ size_t j = 0; j < in_w;)
         {
-            R2Y_ byte_t * block_iter = in_data;
-            for (int n = 0, index = 0; n < F::iterator_size; ++n, block_iter += row_offset)
+            // Test the rows of a whole chunk first
+            if ((j + C) <= in_w)
             {
-                for (int m = 0; m < F::iterator_size; m += 2)
+                int none = 0, full = 0;
+                for (int n = 0; n < N; ++n)
                 {
+                    R2Y_ detail_mask_::coverage cover = mask.chunk(j, i + n);
+                    none += (cover == R2Y_ detail_mask_::cover_NONE);
+                    full += (cover == R2Y_ detail_mask_::cover_FULL);
+                }
+                if (none == N)
+                {
+                    do_sth.skip(C / N);
+                    j += C;
+                    continue;
+                }
+                if (full == N)
+                {
+                    for (GLB_ size_t e = j + C; j < e; j += N)
                     {
-                        R2Y_ rgb_t & ref = tmp[index]; ++index;
-                        ref.b_ = static_cast<GLB_ uint8_t>( ((*block_iter) & 0x0F) << 4 );
-                        ref.g_ = static_cast<GLB_ uint8_t>  ((*block_iter) & 0xF0); ++block_iter;
-                        ref.r_ = static_cast<GLB_ uint8_t>( ((*block_iter) & 0x0F) << 4 );
-                    }
-                    {
-                        R2Y_ rgb_t & ref = tmp[index]; ++index;
-                        ref.b_ = static_cast<GLB_ uint8_t>  ((*block_iter) & 0xF0); ++block_iter;
-                        ref.g_ = static_cast<GLB_ uint8_t>( ((*block_iter) & 0x0F) << 4 );
-                        ref.r_ = static_cast<GLB_ uint8_t>  ((*block_iter) & 0xF0); ++block_iter;
+                        for (int n = 0, index = 0; n < N; ++n)
+                            for (int m = 0; m < N; ++m, ++index) tmp[index] = get(j + m, i + n);
+                        STD_ forward<T>(do_sth)(tmp);
                     }
+                    continue;
                 }
             }
-            STD_ forward<T>(do_sth)(tmp);
+            // Block by block, up to the end of this chunk
+            GLB_ size_t e = (j + C < in_w) ? (j + C) : in_w;
+            for (; j < e; j += N)
+            {
+                int sum = 0;
+                for (int n = 0, index = 0; n < N; ++n)
+                    for (int m = 0; m < N; ++m, ++index) sum += (alpha[index] = mask.alpha(j + m, i + n));
+                if (sum == 0)
+                {
+                    do_sth.skip(1);
+                    continue;
+                }
+                for (int n = 0, index = 0; n < N; ++n)
+                    for (int m = 0; m < N; ++m, ++index) tmp[index] = get(j + m, i + n);
+                if (sum == (0xFF * N * N)) STD_ forward<T>(do_sth)(tmp);
+                else                       STD_ forward<T>(do_sth)(tmp, alpha);
+            }
         }
     }
 }
 
-/* 888X */
+} // namespace detail_walker_
 
-template <R2Y_ supported S, typename T, typename F = STD_ remove_reference_t<T>>
+/* 888/565/555/444/888X */
+
+template <R2Y_ supported S, typename T>
 auto pixel_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T && do_sth)
-    -> STD_ enable_if_t<(S == R2Y_ rgb_888X && F::iterator_size == 1 && F::is_block == 0)>
+    -> STD_ enable_if_t<(S == R2Y_ rgb_888 || S == R2Y_ rgb_565 || S == R2Y_ rgb_555 ||
+                         S == R2Y_ rgb_444 || S == R2Y_ rgb_888X)>
 {
-    GLB_ size_t size = calculate_size<S>(in_w, in_h);
-    assert((size % 4) == 0); // 4 input bytes convert to 1 pixel (3 bytes)
-    GLB_ uint32_t * cur_pixel = reinterpret_cast<GLB_ uint32_t *>(in_data);
-    for (GLB_ size_t i = 0; i < size; i += 4, ++cur_pixel)
-    {
-        STD_ forward<T>(do_sth)(*reinterpret_cast<R2Y_ rgb_t *>(cur_pixel));
-    }
+    R2Y_ detail_walker_::foreach_xy(in_w, in_h,
+        R2Y_ detail_walker_::make_pixels<S>(in_data, in_w, in_h, 1), STD_ forward<T>(do_sth));
 }
 
-template <R2Y_ supported S, typename T, typename F = STD_ remove_reference_t<T>>
+/* 161616 */
+
+template <R2Y_ supported S, typename T>
 auto pixel_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T && do_sth)
-    -> STD_ enable_if_t<(S == R2Y_ rgb_888X && F::iterator_size > 1 && F::is_block == 0)>
+    -> STD_ enable_if_t<(S == R2Y_ rgb_161616)>
 {
-    GLB_ size_t size = calculate_size<S>(in_w, in_h);
-    assert((size % 4) == 0); // 4 input bytes convert to 1 pixel (3 bytes)
-    R2Y_ rgb_t tmp[F::iterator_size];
-    GLB_ uint32_t * cur_pixel = reinterpret_cast<GLB_ uint32_t *>(in_data);
-    for (GLB_ size_t i = 0; i < size; i += (4 * F::iterator_size))
-    {
-        for (int n = 0; n < F::iterator_size; ++n, ++cur_pixel)
-        {
-            tmp[n] = *reinterpret_cast<R2Y_ rgb_t *>(cur_pixel);
-        }
-        STD_ forward<T>(do_sth)(tmp);
-    }
+    R2Y_ detail_walker_::foreach_xy(in_w, in_h,
+        R2Y_ detail_walker_::plain_pixels<R2Y_ rgb16_t>{ in_data, in_w }, STD_ forward<T>(do_sth));
 }
 
-template <R2Y_ supported S, typename T, typename F = STD_ remove_reference_t<T>>
+/* IDX 8 */
+
+template <R2Y_ supported S, typename T>
 auto pixel_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T && do_sth)
-    -> STD_ enable_if_t<(S == R2Y_ rgb_888X && F::iterator_size > 1 && F::is_block == 1)>
-{
-    assert((in_w % F::iterator_size) == 0);
-    assert((in_h % F::iterator_size) == 0);
-    R2Y_ rgb_t tmp[F::iterator_size * F::iterator_size];
-    GLB_ size_t row_offset = in_w - F::iterator_size;
-    GLB_ uint32_t * cur_pixel = reinterpret_cast<GLB_ uint32_t *>(in_data);
-    for (GLB_ size_t i = 0; i < in_h; i += F::iterator_size, cur_pixel += (in_w * (F::iterator_size - 1)))
-    {
-        for (GLB_ size_t j = 0; j < in_w; j += F::iterator_size, cur_pixel += F::iterator_size)
-        {
-            GLB_ uint32_t * block_iter = cur_pixel;
-            for (int n = 0, index = 0; n < F::iterator_size; ++n, block_iter += row_offset)
-            {
-                for (int m = 0; m < F::iterator_size; ++m, ++index, ++block_iter)
-                {
-                    tmp[index] = *reinterpret_cast<R2Y_ rgb_t *>(block_iter);
-                }
-            }
-            STD_ forward<T>(do_sth)(tmp);
-        }
-    }
+    -> STD_ enable_if_t<(S == R2Y_ idx_8)>
+{
+    R2Y_ detail_walker_::foreach_xy(in_w, in_h,
+        R2Y_ detail_walker_::make_pixels<S>(in_data, in_w, in_h, 1), STD_ forward<T>(do_sth));
 }
 
-#pragma push_macro("R2Y_HELPER_")
-#undef  R2Y_HELPER_
-#define R2Y_HELPER_ R2Y_ detail_helper_::
+/* Bayer RGGB/BGGR/GRBG/GBRG, demosaiced on the fly */
 
-/* YUYV/YVYU/UYVY/VYUY */
+template <R2Y_ supported S, typename Rows, typename T, typename F = STD_ remove_reference_t<T>>
+void bayer_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T && do_sth)
+{
+    // A block walk touches its own rows, plus one more above and below
+    enum { rows = (F::is_block ? F::iterator_size : 1) + 2 };
+    R2Y_ detail_walker_::foreach_xy(in_w, in_h,
+        R2Y_ detail_bayer_::demosaic<S, Rows>{ in_data, in_w, in_h, rows }, STD_ forward<T>(do_sth));
+}
 
-template <R2Y_ supported S, typename T, typename F = STD_ remove_reference_t<T>>
+template <R2Y_ supported S, typename T>
 auto pixel_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T && do_sth)
-    -> STD_ enable_if_t<((S == R2Y_ yuv_YUYV || S == R2Y_ yuv_YVYU ||
-                          S == R2Y_ yuv_UYVY || S == R2Y_ yuv_VYUY) && F::iterator_size == 1 && F::is_block == 0)>
+    -> STD_ enable_if_t<(S == R2Y_ bayer_RGGB || S == R2Y_ bayer_BGGR ||
+                         S == R2Y_ bayer_GRBG || S == R2Y_ bayer_GBRG)>
 {
-    auto yuv = reinterpret_cast<R2Y_HELPER_ packed_yuv_t<S>*>(in_data);
-    for (GLB_ size_t i = 0; i < (in_w * in_h); i += R2Y_ iterator<S>::iterator_size, ++yuv)
-    {
-        R2Y_ yuv_t tmp[R2Y_ iterator<S>::iterator_size] =
-        {
-            { yuv->cr_, yuv->cb_, yuv->y0_ },
-            { yuv->cr_, yuv->cb_, yuv->y1_ }
-        };
-        STD_ forward<T>(do_sth)(tmp);
-    }
+    R2Y_ bayer_foreach<S, R2Y_ detail_bayer_::plain_rows<R2Y_ byte_t>>(in_data, in_w, in_h, STD_ forward<T>(do_sth));
 }
 
-/* Y41P */
+/* Bayer RAW10/RAW12, unpacked row by row while walking */
 
-template <R2Y_ supported S, typename T, typename F = STD_ remove_reference_t<T>>
+template <R2Y_ supported S, typename T>
 auto pixel_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T && do_sth)
-    -> STD_ enable_if_t<(S == R2Y_ yuv_Y41P && F::iterator_size == 1 && F::is_block == 0)>
+    -> STD_ enable_if_t<(S == R2Y_ bayer_RGGB10 || S == R2Y_ bayer_BGGR10 ||
+                         S == R2Y_ bayer_GRBG10 || S == R2Y_ bayer_GBRG10)>
 {
-    auto yuv = reinterpret_cast<R2Y_HELPER_ packed_yuv_t<S>*>(in_data);
-    for (GLB_ size_t i = 0; i < (in_w * in_h); i += R2Y_ iterator<S>::iterator_size, ++yuv)
-    {
-        R2Y_ yuv_t tmp[R2Y_ iterator<S>::iterator_size] =
-        {
-            { yuv->v0_, yuv->u0_, yuv->y0_ },
-            { yuv->v0_, yuv->u0_, yuv->y1_ },
-            { yuv->v0_, yuv->u0_, yuv->y2_ },
-            { yuv->v0_, yuv->u0_, yuv->y3_ },
-            { yuv->v1_, yuv->u1_, yuv->y4_ },
-            { yuv->v1_, yuv->u1_, yuv->y5_ },
-            { yuv->v1_, yuv->u1_, yuv->y6_ },
-            { yuv->v1_, yuv->u1_, yuv->y7_ }
-        };
-        STD_ forward<T>(do_sth)(tmp);
-    }
+    R2Y_ bayer_foreach<S, R2Y_ detail_bayer_::packed_rows<10>>(in_data, in_w, in_h, STD_ forward<T>(do_sth));
 }
 
-/* Y411 */
+template <R2Y_ supported S, typename T>
+auto pixel_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T && do_sth)
+    -> STD_ enable_if_t<(S == R2Y_ bayer_RGGB12 || S == R2Y_ bayer_BGGR12 ||
+                         S == R2Y_ bayer_GRBG12 || S == R2Y_ bayer_GBRG12)>
+{
+    R2Y_ bayer_foreach<S, R2Y_ detail_bayer_::packed_rows<12>>(in_data, in_w, in_h, STD_ forward<T>(do_sth));
+}
 
-template <R2Y_ supported S, typename T, typename F = STD_ remove_reference_t<T>>
+/* YUYV/YVYU/UYVY/VYUY/Y41P/Y411/NV24/NV42/YV12/YU12/NV12/NV21 */
+
+template <R2Y_ supported S, typename T>
 auto pixel_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T && do_sth)
-    -> STD_ enable_if_t<(S == R2Y_ yuv_Y411 && F::iterator_size == 1 && F::is_block == 0)>
+    -> STD_ enable_if_t<(S == R2Y_ yuv_YUYV || S == R2Y_ yuv_YVYU || S == R2Y_ yuv_UYVY || S == R2Y_ yuv_VYUY ||
+                         S == R2Y_ yuv_Y41P || S == R2Y_ yuv_Y411 || S == R2Y_ yuv_NV24 || S == R2Y_ yuv_NV42 ||
+                         S == R2Y_ yuv_YV12 || S == R2Y_ yuv_YU12 || S == R2Y_ yuv_NV12 || S == R2Y_ yuv_NV21)>
 {
-    auto yuv = reinterpret_cast<R2Y_HELPER_ packed_yuv_t<S>*>(in_data);
-    for (GLB_ size_t i = 0; i < (in_w * in_h); i += R2Y_ iterator<S>::iterator_size, ++yuv)
-    {
-        R2Y_ yuv_t tmp[R2Y_ iterator<S>::iterator_size] =
-        {
-            { yuv->cr_, yuv->cb_, yuv->y0_ },
-            { yuv->cr_, yuv->cb_, yuv->y1_ },
-            { yuv->cr_, yuv->cb_, yuv->y2_ },
-            { yuv->cr_, yuv->cb_, yuv->y3_ }
-        };
-        STD_ forward<T>(do_sth)(tmp);
-    }
+    R2Y_ detail_walker_::foreach_xy(in_w, in_h,
+        R2Y_ detail_walker_::make_pixels<S>(in_data, in_w, in_h, 1), STD_ forward<T>(do_sth));
 }
 
-/* NV24/NV42 */
+/* YCoCg/YCoCg-R/RCT/ICT */
 
-template <R2Y_ supported S, typename T, typename F = STD_ remove_reference_t<T>>
+template <R2Y_ supported S, typename T>
 auto pixel_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T && do_sth)
-    -> STD_ enable_if_t<((S == R2Y_ yuv_NV24 || S == R2Y_ yuv_NV42) && F::iterator_size == 1 && F::is_block == 0)>
+    -> STD_ enable_if_t<R2Y_ is_ycc<S>::value>
 {
-    R2Y_ byte_t * y = nullptr;
-    R2Y_HELPER_ planar_uv_t<S> uv;
-    R2Y_HELPER_ yuv_planar <S>(y, uv, in_data, in_w, in_h);
-    for (GLB_ size_t i = 0; i < (in_w * in_h); ++i, ++y, ++(uv.uv_))
-    {
-        STD_ forward<T>(do_sth)(R2Y_ yuv_t { uv.uv_->cr_, uv.uv_->cb_, *y });
-    }
+    R2Y_ detail_walker_::foreach_xy(in_w, in_h,
+        R2Y_ detail_walker_::ycc_pixels<S>{ in_data, in_w, in_h }, STD_ forward<T>(do_sth));
 }
 
-/* YV12/YU12/NV12/NV21 */
+/* P010 */
 
-template <R2Y_ supported S, typename T, typename F = STD_ remove_reference_t<T>>
+template <R2Y_ supported S, typename T>
 auto pixel_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T && do_sth)
-    -> STD_ enable_if_t<((S == R2Y_ yuv_YV12 || S == R2Y_ yuv_YU12 ||
-                          S == R2Y_ yuv_NV12 || S == R2Y_ yuv_NV21) && F::iterator_size == 1 && F::is_block == 0)>
-{
-    R2Y_ byte_t * y = nullptr;
-    R2Y_HELPER_ planar_uv_t<S> uv;
-    R2Y_HELPER_ yuv_planar <S>(y, uv, in_data, in_w, in_h);
-    R2Y_HELPER_ planar_uv_t<S> uv1 = uv;
-    for (GLB_ size_t i = 0; i < in_h; i += 2)
-    {
-        for (GLB_ size_t j = 0; j < in_w; j += 2)
-        {
-            R2Y_ yuv_t tmp[2];
-            tmp[0].y_ = *y; ++y;
-            tmp[1].y_ = *y; ++y;
-            R2Y_HELPER_  get_planar_uv(tmp[0].u_, tmp[0].v_, uv);
-            R2Y_HELPER_  get_planar_uv(tmp[1].u_, tmp[1].v_, uv);
-            R2Y_HELPER_ next_planar_uv(uv);
-            STD_ forward<T>(do_sth)(tmp);
-        }
-        for (GLB_ size_t j = 0; j < in_w; j += 2)
-        {
-            R2Y_ yuv_t tmp[2];
-            tmp[0].y_ = *y; ++y;
-            tmp[1].y_ = *y; ++y;
-            R2Y_HELPER_  get_planar_uv(tmp[0].u_, tmp[0].v_, uv1);
-            R2Y_HELPER_  get_planar_uv(tmp[1].u_, tmp[1].v_, uv1);
-            R2Y_HELPER_ next_planar_uv(uv1);
-            STD_ forward<T>(do_sth)(tmp);
-        }
-    }
+    -> STD_ enable_if_t<(S == R2Y_ yuv_P010)>
+{
+    R2Y_ detail_walker_::foreach_xy(in_w, in_h,
+        R2Y_ detail_walker_::p010_pixels{ in_data, in_w, in_h }, STD_ forward<T>(do_sth));
 }
 
-#pragma pop_macro("R2Y_HELPER_")
+/* Y800 */
+
+template <R2Y_ supported S, typename T>
+auto pixel_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, T && do_sth)
+    -> STD_ enable_if_t<(S == R2Y_ yuv_Y800)>
+{
+    R2Y_ detail_walker_::foreach_xy(in_w, in_h,
+        R2Y_ detail_walker_::make_pixels<S>(in_data, in_w, in_h, 1), STD_ forward<T>(do_sth));
+}
+
+/* Any format with a fetcher, only the pixels selected by a mask */
+
+template <R2Y_ supported S, typename T, typename F = STD_ remove_reference_t<T>>
+void masked_foreach(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, R2Y_ mask const & m, T && do_sth)
+{
+    enum { rows = (F::is_block ? F::iterator_size : 1) + 2 };
+    R2Y_ detail_walker_::foreach_masked(in_w, in_h, R2Y_ detail_walker_::make_pixels<S>(in_data, in_w, in_h, rows),
+                                        R2Y_ detail_mask_::mask_reader{ m, in_w }, STD_ forward<T>(do_sth));
+}
@@ -0,0 +1,121 @@
+/*
+    rgb2yuv - Code covered by the MIT License
+    Author: mutouyun (http://orzz.org)
+*/
+
+////////////////////////////////////////////////////////////////
+/// Splitting, merging and copying planes
+////////////////////////////////////////////////////////////////
+
+namespace detail_plane_ {
+
+/* ot[2i] = in_0[i], ot[2i + 1] = in_1[i] */
+inline void interleave(R2Y_ byte_t const * in_0, R2Y_ byte_t const * in_1, R2Y_ byte_t * ot_data, GLB_ size_t in_n)
+{
+    GLB_ size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+    for (; (i + 16) <= in_n; i += 16)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<__m128i const *>(in_0 + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<__m128i const *>(in_1 + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(ot_data + (i * 2)     ), _mm_unpacklo_epi8(a, b));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(ot_data + (i * 2) + 16), _mm_unpackhi_epi8(a, b));
+    }
+#elif defined(__ARM_NEON)
+    for (; (i + 16) <= in_n; i += 16)
+    {
+        uint8x16x2_t ab = { { vld1q_u8(in_0 + i), vld1q_u8(in_1 + i) } };
+        vst2q_u8(ot_data + (i * 2), ab);
+    }
+#endif
+    for (; i < in_n; ++i)
+    {
+        ot_data[(i * 2)    ] = in_0[i];
+        ot_data[(i * 2) + 1] = in_1[i];
+    }
+}
+
+/* ot_0[i] = in[2i], ot_1[i] = in[2i + 1] */
+inline void deinterleave(R2Y_ byte_t const * in_data, R2Y_ byte_t * ot_0, R2Y_ byte_t * ot_1, GLB_ size_t in_n)
+{
+    GLB_ size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+    __m128i const lo = _mm_set1_epi16(0x00FF);
+    for (; (i + 16) <= in_n; i += 16)
+    {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<__m128i const *>(in_data + (i * 2)     ));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<__m128i const *>(in_data + (i * 2) + 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(ot_0 + i),
+                         _mm_packus_epi16(_mm_and_si128(x, lo), _mm_and_si128(y, lo)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(ot_1 + i),
+                         _mm_packus_epi16(_mm_srli_epi16(x, 8), _mm_srli_epi16(y, 8)));
+    }
+#elif defined(__ARM_NEON)
+    for (; (i + 16) <= in_n; i += 16)
+    {
+        uint8x16x2_t ab = vld2q_u8(in_data + (i * 2));
+        vst1q_u8(ot_0 + i, ab.val[0]);
+        vst1q_u8(ot_1 + i, ab.val[1]);
+    }
+#endif
+    for (; i < in_n; ++i)
+    {
+        ot_0[i] = in_data[(i * 2)    ];
+        ot_1[i] = in_data[(i * 2) + 1];
+    }
+}
+
+/* Whether Cb comes first in the combined CbCr plane of S */
+template <R2Y_ supported S>
+struct cb_first
+{
+    typedef STD_ remove_pointer_t<decltype(STD_ declval<R2Y_ detail_helper_::planar_uv_t<S>>().uv_)> pair_t;
+    enum { value = (offsetof(pair_t, cb_) == 0) };
+};
+
+} // namespace detail_plane_
+
+/*
+ * Merge a Cb and a Cr plane of in_n samples each into the combined CbCr plane of S,
+ * in the same order as the frames of S made by this library.
+ */
+template <R2Y_ supported S>
+STD_ enable_if_t<(S == R2Y_ yuv_NV24 || S == R2Y_ yuv_NV42 || S == R2Y_ yuv_NV12 || S == R2Y_ yuv_NV21)>
+    interleave(R2Y_ byte_t const * in_u, R2Y_ byte_t const * in_v, R2Y_ byte_t * ot_uv, GLB_ size_t in_n)
+{
+    assert((in_n == 0) || (in_u != NULL && in_v != NULL && ot_uv != NULL));
+    if (R2Y_ detail_plane_::cb_first<S>::value)
+         R2Y_ detail_plane_::interleave(in_u, in_v, ot_uv, in_n);
+    else R2Y_ detail_plane_::interleave(in_v, in_u, ot_uv, in_n);
+}
+
+/* Split the combined CbCr plane of S (in_n pairs) into a Cb and a Cr plane */
+template <R2Y_ supported S>
+STD_ enable_if_t<(S == R2Y_ yuv_NV24 || S == R2Y_ yuv_NV42 || S == R2Y_ yuv_NV12 || S == R2Y_ yuv_NV21)>
+    deinterleave(R2Y_ byte_t const * in_uv, R2Y_ byte_t * ot_u, R2Y_ byte_t * ot_v, GLB_ size_t in_n)
+{
+    assert((in_n == 0) || (in_uv != NULL && ot_u != NULL && ot_v != NULL));
+    if (R2Y_ detail_plane_::cb_first<S>::value)
+         R2Y_ detail_plane_::deinterleave(in_uv, ot_u, ot_v, in_n);
+    else R2Y_ detail_plane_::deinterleave(in_uv, ot_v, ot_u, in_n);
+}
+
+/*
+ * Copy in_h rows of in_row bytes between two strides (pitches),
+ * e.g. from a tightly packed plane into a frame with aligned rows, or back.
+ */
+inline void repitch(R2Y_ byte_t const * in_data, GLB_ size_t in_pitch,
+                    R2Y_ byte_t * ot_data, GLB_ size_t ot_pitch, GLB_ size_t in_row, GLB_ size_t in_h)
+{
+    assert(in_data != NULL && ot_data != NULL);
+    assert(in_row <= in_pitch && in_row <= ot_pitch);
+    if ((in_pitch == in_row) && (ot_pitch == in_row))
+    {
+        memcpy(ot_data, in_data, in_row * in_h); // both are contiguous
+        return;
+    }
+    for (GLB_ size_t i = 0; i < in_h; ++i, in_data += in_pitch, ot_data += ot_pitch)
+    {
+        memcpy(ot_data, in_data, in_row);
+    }
+}
@@ -20,6 +20,108 @@ struct allocator
     }
 };
 
+////////////////////////////////////////////////////////////////
+/// Define a huge page aware memory allocator for large frames
+////////////////////////////////////////////////////////////////
+
+/*
+ * Large frames (an 8K NV12 frame is ~50 MB) pay for 4 KB pages twice:
+ * once on first touch and again on dTLB misses of the strided block walks.
+ * Blocks of 2 MB or more are mapped on 2 MB aligned regions with MADV_HUGEPAGE,
+ * smaller ones are taken from the heap as usual.
+ * Define R2Y_USE_HUGETLB to try MAP_HUGETLB (needs reserved huge pages) first.
+ * Use it with: #define R2Y_ALLOC_ ::r2y::huge_allocator
+ */
+
+#if defined(__linux__)
+
+struct huge_allocator
+{
+    enum : GLB_ size_t
+    {
+        page_size   = 4096,
+        huge_size   = 2 * 1024 * 1024,
+        header_size = 64 // keeps the user data cache line aligned
+    };
+
+    struct header_t
+    {
+        void *      base_;
+        GLB_ size_t size_; // 0 means the block comes from the heap
+    };
+
+    static GLB_ size_t round_up(GLB_ size_t size, GLB_ size_t align)
+    {
+        return (size + align - 1) & ~(align - 1);
+    }
+
+    static void * alloc(GLB_ size_t size)
+    {
+        if (size == 0) return NULL;
+        if (size >= huge_size)
+        {
+#if defined(R2Y_USE_HUGETLB) && defined(MAP_HUGETLB)
+            {
+                GLB_ size_t len  = round_up(size + header_size, huge_size);
+                void *      base = GLB_ mmap(NULL, len, PROT_READ | PROT_WRITE,
+                                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                if (base != MAP_FAILED)
+                {
+                    return make_block(base, len, static_cast<R2Y_ byte_t *>(base) + header_size);
+                }
+            }
+#endif
+            // Over-allocate to align the data on 2 MB, then give the slack back
+            GLB_ size_t len  = round_up(size, huge_size);
+            GLB_ size_t map  = len + huge_size;
+            void *      base = GLB_ mmap(NULL, map, PROT_READ | PROT_WRITE,
+                                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (base != MAP_FAILED)
+            {
+                R2Y_ byte_t * head = static_cast<R2Y_ byte_t *>(base);
+                R2Y_ byte_t * data = reinterpret_cast<R2Y_ byte_t *>(
+                                     round_up(reinterpret_cast<GLB_ uintptr_t>(head) + header_size, huge_size));
+                R2Y_ byte_t * from = data - page_size;
+                R2Y_ byte_t * tail = data + len;
+                if (from > head)       GLB_ munmap(head, from - head);
+                if (tail < head + map) GLB_ munmap(tail, (head + map) - tail);
+                // Not fatal if THP is disabled, the block is just backed by 4 KB pages
+                GLB_ madvise(data, len, MADV_HUGEPAGE);
+                return make_block(from, tail - from, data);
+            }
+        }
+        // operator new only aligns on 16 bytes, so over-allocate and round the data up
+        void * base = GLB_ operator new(size + (header_size * 2), STD_ nothrow);
+        if (base == NULL) return NULL;
+        return make_block(base, 0, reinterpret_cast<R2Y_ byte_t *>(
+                                   round_up(reinterpret_cast<GLB_ uintptr_t>(base) + header_size, header_size)));
+    }
+
+    static void free(void * ptr)
+    {
+        if (ptr == NULL) return;
+        header_t * hdr = reinterpret_cast<header_t *>(static_cast<R2Y_ byte_t *>(ptr) - header_size);
+        if (hdr->size_ == 0)
+             GLB_ operator delete(hdr->base_, STD_ nothrow);
+        else GLB_ munmap(hdr->base_, hdr->size_);
+    }
+
+private:
+    static void * make_block(void * base, GLB_ size_t size, R2Y_ byte_t * data)
+    {
+        header_t * hdr = reinterpret_cast<header_t *>(data - header_size);
+        hdr->base_ = base;
+        hdr->size_ = size;
+        return data;
+    }
+};
+
+#else // !__linux__
+
+struct huge_allocator : R2Y_ allocator {};
+
+#endif // __linux__
+
 ////////////////////////////////////////////////////////////////
 /// The limited garbage collection facility for memory block
 ////////////////////////////////////////////////////////////////
@@ -0,0 +1,204 @@
+/*
+    rgb2yuv - Code covered by the MIT License
+    Author: mutouyun (http://orzz.org)
+*/
+
+////////////////////////////////////////////////////////////////
+/// A view of an image converted tile by tile, on demand
+////////////////////////////////////////////////////////////////
+
+/* A converted tile: the rectangle of the image it covers, and a frame of w_ x h_ in the output format */
+struct view_tile
+{
+    GLB_ size_t                   x_, y_, w_, h_;
+    R2Y_ scope_block<R2Y_ byte_t> data_;
+};
+
+/*
+ * e.g. lazy_view<rgb_888X, yuv_NV12> view{ in_data, 30000, 20000, 256, 256, 64 };
+ *      auto t = view.tile(3, 5); // the tile of [768, 1024) x [1280, 1536), converted on the first access
+ * Only the tiles asked for are converted (a crop pipeline over the source), so the cost follows the viewport.
+ * At most capacity tiles are kept, the least recently used one is dropped first.
+ * The cache is a hash table over a fixed array of slots, chained in the order of use,
+ * so a lookup, an insertion and a drop take the same time for any capacity.
+ * A tile handed out stays valid while it is held, even if it is dropped from the cache.
+ * tile() may be called from many threads: the cache is locked only to look up and to insert,
+ * so two threads missing the same tile at once may both convert it, and one of them is kept.
+ * If the slots can't be allocated, nothing is cached and every access converts its tile.
+ */
+template <R2Y_ supported In, R2Y_ supported Ot>
+class lazy_view
+{
+public:
+    typedef STD_ shared_ptr<R2Y_ view_tile const> tile_ptr;
+
+private:
+    /* The tile sizes must not split a step (or a block) of the output */
+    enum
+    {
+        step_w = R2Y_ do_convert_t<Ot>::iterator_size,
+        step_h = R2Y_ do_convert_t<Ot>::is_block ? R2Y_ do_convert_t<Ot>::iterator_size : 1
+    };
+
+    struct slot_t
+    {
+        GLB_ size_t key_;           // ty * tiles_x + tx
+        slot_t *    chain_;         // the next slot of the same bucket
+        slot_t *    prev_, * next_; // the neighbours in the order of use, the most recent first
+        tile_ptr    tile_;
+    };
+
+    R2Y_ byte_t *                 data_;
+    GLB_ size_t                   w_, h_, tile_w_, tile_h_, tiles_x_, tiles_y_;
+    R2Y_ scope_block<slot_t>      slots_;
+    R2Y_ scope_block<slot_t *>    buckets_; // a power of 2 of them, no fewer than the slots
+    GLB_ size_t                   capacity_, used_, mask_;
+    slot_t *                      first_, * last_;
+    GLB_ uint64_t                 hits_, misses_;
+    mutable STD_ mutex            lock_;
+
+    /* The slot of key, or NULL; must be locked */
+    slot_t * find(GLB_ size_t key) const
+    {
+        if (capacity_ == 0) return NULL;
+        slot_t * s = buckets_[key & mask_];
+        while ((s != NULL) && (s->key_ != key)) s = s->chain_;
+        return s;
+    }
+
+    /* Take s out of the order of use; must be locked */
+    void unlink(slot_t * s)
+    {
+        if (s->prev_ != NULL) s->prev_->next_ = s->next_;
+        else                  first_          = s->next_;
+        if (s->next_ != NULL) s->next_->prev_ = s->prev_;
+        else                  last_           = s->prev_;
+    }
+
+    /* Put s first in the order of use; must be locked */
+    void push_front(slot_t * s)
+    {
+        s->prev_ = NULL;
+        s->next_ = first_;
+        if (first_ != NULL) first_->prev_ = s;
+        else                last_         = s;
+        first_ = s;
+    }
+
+    /* An unused slot, or the least recently used one taken out of the cache; must be locked */
+    slot_t * victim(void)
+    {
+        if (used_ < capacity_) return &slots_[used_++];
+        slot_t * v = last_;
+        this->unlink(v);
+        slot_t ** p = &buckets_[v->key_ & mask_];
+        while ((*p) != v) p = &((*p)->chain_);
+        (*p) = v->chain_;
+        return v;
+    }
+
+    tile_ptr convert(GLB_ size_t tx, GLB_ size_t ty) const
+    {
+        GLB_ size_t x = tx * tile_w_, y = ty * tile_h_;
+        GLB_ size_t w = ((w_ - x) < tile_w_) ? (w_ - x) : tile_w_,
+                    h = ((h_ - y) < tile_h_) ? (h_ - y) : tile_h_;
+        R2Y_ view_tile * t = new (STD_ nothrow) R2Y_ view_tile{ x, y, w, h, {} };
+        if (t == NULL) return tile_ptr{};
+        t->data_ = (R2Y_ from<In>() | R2Y_ crop(x, y, w, h) | R2Y_ to<Ot>())(data_, w_, h_);
+        try
+        {
+            return tile_ptr{ t };
+        }
+        catch (STD_ bad_alloc const &)
+        {
+            return tile_ptr{}; // t has been deleted by shared_ptr
+        }
+    }
+
+public:
+    lazy_view(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h,
+              GLB_ size_t tile_w, GLB_ size_t tile_h, GLB_ size_t capacity)
+        : data_(in_data), w_(in_w), h_(in_h), tile_w_(tile_w), tile_h_(tile_h)
+        , tiles_x_((in_w + tile_w - 1) / tile_w), tiles_y_((in_h + tile_h - 1) / tile_h)
+        , slots_(capacity), capacity_(0), used_(0), mask_(0)
+        , first_(NULL), last_(NULL), hits_(0), misses_(0)
+    {
+        assert(in_data != NULL);
+        assert(in_w > 0 && in_h > 0);
+        assert(tile_w > 0 && tile_h > 0 && capacity > 0);
+        assert((tile_w % step_w) == 0 && (tile_h % step_h) == 0);
+        GLB_ size_t n = 1;
+        while (n < capacity) n <<= 1;
+        buckets_.reset(n);
+        if ((slots_.data() == NULL) || (buckets_.data() == NULL)) return;
+        memset(buckets_.data(), 0, buckets_.size());
+        for (GLB_ size_t i = 0; i < capacity; ++i)
+        {
+            new (&slots_[i]) slot_t{ 0, NULL, NULL, NULL, tile_ptr{} };
+        }
+        capacity_ = capacity;
+        mask_     = n - 1;
+    }
+
+    ~lazy_view(void)
+    {
+        for (GLB_ size_t i = 0; i < capacity_; ++i) slots_[i].~slot_t();
+    }
+
+    lazy_view(lazy_view const &) = delete;
+    lazy_view & operator=(lazy_view const &) = delete;
+
+    GLB_ size_t tiles_x(void) const { return tiles_x_; }
+    GLB_ size_t tiles_y(void) const { return tiles_y_; }
+
+    /* The tile (tx, ty), converted if it isn't cached; empty if out of memory */
+    tile_ptr tile(GLB_ size_t tx, GLB_ size_t ty)
+    {
+        assert(tx < tiles_x_ && ty < tiles_y_);
+        GLB_ size_t key = (ty * tiles_x_) + tx;
+        {
+            STD_ lock_guard<STD_ mutex> guard{ lock_ };
+            slot_t * s = this->find(key);
+            if (s != NULL)
+            {
+                this->unlink(s);
+                this->push_front(s);
+                ++hits_;
+                return s->tile_;
+            }
+            ++misses_;
+        }
+        tile_ptr t = this->convert(tx, ty);
+        if (!t || (t->data_.data() == NULL)) return tile_ptr{};
+        STD_ lock_guard<STD_ mutex> guard{ lock_ };
+        if (capacity_ == 0) return t;
+        slot_t * s = this->find(key);
+        if (s != NULL)
+        {
+            this->unlink(s);
+        }
+        else
+        {
+            s = this->victim();
+            s->key_   = key;
+            s->tile_  = t;
+            s->chain_ = buckets_[key & mask_];
+            buckets_[key & mask_] = s;
+        }
+        this->push_front(s);
+        return s->tile_;
+    }
+
+    /* The tile covering the pixel (x, y) */
+    tile_ptr tile_at(GLB_ size_t x, GLB_ size_t y)
+    {
+        return this->tile(x / tile_w_, y / tile_h_);
+    }
+
+    void stats(GLB_ uint64_t & ot_hits, GLB_ uint64_t & ot_misses) const
+    {
+        STD_ lock_guard<STD_ mutex> guard{ lock_ };
+        ot_hits   = hits_;
+        ot_misses = misses_;
+    }
+};
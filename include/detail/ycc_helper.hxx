@@ -0,0 +1,159 @@
+/*
+    rgb2yuv - Code covered by the MIT License
+    Author: mutouyun (http://orzz.org)
+*/
+
+namespace detail_ycc_ {
+
+R2Y_FORCE_INLINE_ GLB_ uint8_t clip(GLB_ int32_t value)
+{
+    return static_cast<GLB_ uint8_t>( (value < 0) ? 0 : ((value > 0xFF) ? 0xFF : value) );
+}
+
+/*
+ * YCoCg, 8-bit chroma with an offset of 128 (lossy)
+ * See: https://en.wikipedia.org/wiki/YCoCg
+ */
+
+R2Y_FORCE_INLINE_ void ycocg_forward(R2Y_ rgb_t const & in_p, R2Y_ byte_t & y, R2Y_ byte_t & co, R2Y_ byte_t & cg)
+{
+    GLB_ int32_t r = in_p.r_, g = in_p.g_, b = in_p.b_;
+    y  = static_cast<R2Y_ byte_t>((r + (g << 1) + b + 2) >> 2);
+    co = clip(((r - b + 1) >> 1) + 128);
+    cg = clip(((-r + (g << 1) - b + 2) >> 2) + 128);
+}
+
+R2Y_FORCE_INLINE_ R2Y_ rgb_t ycocg_inverse(GLB_ int32_t y, GLB_ int32_t co, GLB_ int32_t cg)
+{
+    co -= 128;
+    cg -= 128;
+    GLB_ int32_t t = y - cg;
+    R2Y_ rgb_t ot_p;
+    ot_p.r_ = clip(t + co);
+    ot_p.g_ = clip(y + cg);
+    ot_p.b_ = clip(t - co);
+    return ot_p;
+}
+
+/*
+ * YCoCg-R, exactly reversible with integer adds and shifts,
+ * Co and Cg take 9 bits ([-255, 255]).
+ * See: H.S. Malvar, G.J. Sullivan, YCoCg-R: A Color Space with RGB Reversibility
+ *      and Low Dynamic Range (JVT-I014r3)
+ */
+
+R2Y_FORCE_INLINE_ void ycocgr_forward(R2Y_ rgb_t const & in_p, GLB_ int16_t & y, GLB_ int16_t & co, GLB_ int16_t & cg)
+{
+    GLB_ int32_t o = in_p.r_ - in_p.b_;
+    GLB_ int32_t t = in_p.b_ + (o >> 1);
+    GLB_ int32_t g = in_p.g_ - t;
+    y  = static_cast<GLB_ int16_t>(t + (g >> 1));
+    co = static_cast<GLB_ int16_t>(o);
+    cg = static_cast<GLB_ int16_t>(g);
+}
+
+R2Y_FORCE_INLINE_ R2Y_ rgb_t ycocgr_inverse(GLB_ int32_t y, GLB_ int32_t co, GLB_ int32_t cg)
+{
+    GLB_ int32_t t = y - (cg >> 1);
+    GLB_ int32_t b = t - (co >> 1);
+    R2Y_ rgb_t ot_p;
+    ot_p.g_ = static_cast<GLB_ uint8_t>(cg + t);
+    ot_p.b_ = static_cast<GLB_ uint8_t>(b);
+    ot_p.r_ = static_cast<GLB_ uint8_t>(b + co);
+    return ot_p;
+}
+
+/*
+ * JPEG 2000 component transforms, after the DC level shift (-128) of the 8-bit samples.
+ * See: ITU-T T.800, Annex G
+ */
+
+/* RCT, reversible: Y = floor((R + 2G + B) / 4), Cb = B - G, Cr = R - G */
+
+R2Y_FORCE_INLINE_ void rct_forward(R2Y_ rgb_t const & in_p, GLB_ int16_t & y, GLB_ int16_t & cb, GLB_ int16_t & cr)
+{
+    GLB_ int32_t r = in_p.r_, g = in_p.g_, b = in_p.b_;
+    y  = static_cast<GLB_ int16_t>(((r + (g << 1) + b) >> 2) - 128);
+    cb = static_cast<GLB_ int16_t>(b - g);
+    cr = static_cast<GLB_ int16_t>(r - g);
+}
+
+R2Y_FORCE_INLINE_ R2Y_ rgb_t rct_inverse(GLB_ int32_t y, GLB_ int32_t cb, GLB_ int32_t cr)
+{
+    GLB_ int32_t g = (y + 128) - ((cb + cr) >> 2);
+    R2Y_ rgb_t ot_p;
+    ot_p.g_ = static_cast<GLB_ uint8_t>(g);
+    ot_p.b_ = static_cast<GLB_ uint8_t>(cb + g);
+    ot_p.r_ = static_cast<GLB_ uint8_t>(cr + g);
+    return ot_p;
+}
+
+/*
+ * ICT, irreversible (the BT.601 full range matrix), in 16.16 fixed point:
+ * Y  =  0.299    R + 0.587    G + 0.114    B
+ * Cb = -0.168736 R - 0.331264 G + 0.5      B
+ * Cr =  0.5      R - 0.418688 G - 0.081312 B
+ */
+
+R2Y_FORCE_INLINE_ void ict_forward(R2Y_ rgb_t const & in_p, GLB_ int16_t & y, GLB_ int16_t & cb, GLB_ int16_t & cr)
+{
+    GLB_ int32_t r = in_p.r_ - 128, g = in_p.g_ - 128, b = in_p.b_ - 128;
+    y  = static_cast<GLB_ int16_t>(( 19595 * r + 38470 * g +  7471 * b + 32768) >> 16);
+    cb = static_cast<GLB_ int16_t>((-11059 * r - 21709 * g + 32768 * b + 32768) >> 16);
+    cr = static_cast<GLB_ int16_t>(( 32768 * r - 27439 * g -  5329 * b + 32768) >> 16);
+}
+
+R2Y_FORCE_INLINE_ R2Y_ rgb_t ict_inverse(GLB_ int32_t y, GLB_ int32_t cb, GLB_ int32_t cr)
+{
+    y = (y + 128) << 16;
+    R2Y_ rgb_t ot_p;
+    ot_p.r_ = clip((y + 91881 * cr + 32768) >> 16);
+    ot_p.g_ = clip((y - 22554 * cb - 46802 * cr + 32768) >> 16);
+    ot_p.b_ = clip((y + 116130 * cb + 32768) >> 16);
+    return ot_p;
+}
+
+/*
+ * The transform and plane sample type of each format,
+ * shared by the planar iterators and walkers.
+ */
+
+template <R2Y_ supported S> struct color_transform;
+
+template <> struct color_transform<R2Y_ ycc_YCoCg>
+{
+    typedef R2Y_ byte_t sample_t;
+    R2Y_FORCE_INLINE_ static void forward(R2Y_ rgb_t const & in_p, sample_t & c0, sample_t & c1, sample_t & c2)
+    { R2Y_ detail_ycc_::ycocg_forward(in_p, c0, c1, c2); }
+    R2Y_FORCE_INLINE_ static R2Y_ rgb_t inverse(GLB_ int32_t c0, GLB_ int32_t c1, GLB_ int32_t c2)
+    { return R2Y_ detail_ycc_::ycocg_inverse(c0, c1, c2); }
+};
+
+template <> struct color_transform<R2Y_ ycc_YCoCgR>
+{
+    typedef GLB_ int16_t sample_t;
+    R2Y_FORCE_INLINE_ static void forward(R2Y_ rgb_t const & in_p, sample_t & c0, sample_t & c1, sample_t & c2)
+    { R2Y_ detail_ycc_::ycocgr_forward(in_p, c0, c1, c2); }
+    R2Y_FORCE_INLINE_ static R2Y_ rgb_t inverse(GLB_ int32_t c0, GLB_ int32_t c1, GLB_ int32_t c2)
+    { return R2Y_ detail_ycc_::ycocgr_inverse(c0, c1, c2); }
+};
+
+template <> struct color_transform<R2Y_ ycc_RCT>
+{
+    typedef GLB_ int16_t sample_t;
+    R2Y_FORCE_INLINE_ static void forward(R2Y_ rgb_t const & in_p, sample_t & c0, sample_t & c1, sample_t & c2)
+    { R2Y_ detail_ycc_::rct_forward(in_p, c0, c1, c2); }
+    R2Y_FORCE_INLINE_ static R2Y_ rgb_t inverse(GLB_ int32_t c0, GLB_ int32_t c1, GLB_ int32_t c2)
+    { return R2Y_ detail_ycc_::rct_inverse(c0, c1, c2); }
+};
+
+template <> struct color_transform<R2Y_ ycc_ICT>
+{
+    typedef GLB_ int16_t sample_t;
+    R2Y_FORCE_INLINE_ static void forward(R2Y_ rgb_t const & in_p, sample_t & c0, sample_t & c1, sample_t & c2)
+    { R2Y_ detail_ycc_::ict_forward(in_p, c0, c1, c2); }
+    R2Y_FORCE_INLINE_ static R2Y_ rgb_t inverse(GLB_ int32_t c0, GLB_ int32_t c1, GLB_ int32_t c2)
+    { return R2Y_ detail_ycc_::ict_inverse(c0, c1, c2); }
+};
+
+} // namespace detail_ycc_
@@ -74,69 +74,113 @@ R2Y_FORCE_INLINE_ auto next_planar_uv(planar_uv_t<S> & ot_uv)
     ++(ot_uv.cr_);
 }
 
+template <R2Y_ supported S>
+R2Y_FORCE_INLINE_ auto get_planar_uv(GLB_ uint8_t & ot_u, GLB_ uint8_t & ot_v, const planar_uv_t<S> & in_uv, GLB_ size_t in_i)
+    -> STD_ enable_if_t<(S == R2Y_ yuv_NV24 || S == R2Y_ yuv_NV42 || S == R2Y_ yuv_NV12 || S == R2Y_ yuv_NV21)>
+{
+    ot_u = in_uv.uv_[in_i].cb_;
+    ot_v = in_uv.uv_[in_i].cr_;
+}
+
+template <R2Y_ supported S>
+R2Y_FORCE_INLINE_ auto get_planar_uv(GLB_ uint8_t & ot_u, GLB_ uint8_t & ot_v, const planar_uv_t<S> & in_uv, GLB_ size_t in_i)
+    -> STD_ enable_if_t<!(S == R2Y_ yuv_NV24 || S == R2Y_ yuv_NV42 || S == R2Y_ yuv_NV12 || S == R2Y_ yuv_NV21)>
+{
+    ot_u = in_uv.cb_[in_i];
+    ot_v = in_uv.cr_[in_i];
+}
+
+/* The chroma subsampling of the planar formats */
+
+template <R2Y_ supported S> struct chroma_sub;
+
+template <> struct chroma_sub<R2Y_ yuv_NV24> { enum { x = 1, y = 1 }; };
+template <> struct chroma_sub<R2Y_ yuv_NV42> { enum { x = 1, y = 1 }; };
+template <> struct chroma_sub<R2Y_ yuv_422P> { enum { x = 2, y = 1 }; };
+template <> struct chroma_sub<R2Y_ yuv_YV12> { enum { x = 2, y = 2 }; };
+template <> struct chroma_sub<R2Y_ yuv_YU12> { enum { x = 2, y = 2 }; };
+template <> struct chroma_sub<R2Y_ yuv_NV12> { enum { x = 2, y = 2 }; };
+template <> struct chroma_sub<R2Y_ yuv_NV21> { enum { x = 2, y = 2 }; };
+template <> struct chroma_sub<R2Y_ yuv_411P> { enum { x = 4, y = 1 }; };
+template <> struct chroma_sub<R2Y_ yuv_YUV9> { enum { x = 4, y = 4 }; };
+template <> struct chroma_sub<R2Y_ yuv_YVU9> { enum { x = 4, y = 4 }; };
+
+/* The Y plane first, then the chroma planes, each rounded up on the edges */
+
 template <R2Y_ supported S, R2Y_ plane_type P>
-R2Y_FORCE_INLINE_ auto split(R2Y_ byte_t * in_data, GLB_ size_t /*in_size*/)
+R2Y_FORCE_INLINE_ auto split(R2Y_ byte_t * in_data, GLB_ size_t /*in_w*/, GLB_ size_t /*in_h*/)
     -> STD_ enable_if_t<(P == R2Y_ plane_Y), R2Y_ byte_t *>
 {
     return in_data;
 }
 
 template <R2Y_ supported S, R2Y_ plane_type P>
-R2Y_FORCE_INLINE_ auto split(R2Y_ byte_t * in_data, GLB_ size_t in_size)
+R2Y_FORCE_INLINE_ auto split(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h)
     -> STD_ enable_if_t<((P == R2Y_ plane_U) && (S == R2Y_ yuv_YU12 || S == R2Y_ yuv_411P ||
                                                  S == R2Y_ yuv_422P || S == R2Y_ yuv_YUV9)) ||
                         ((P == R2Y_ plane_V) && (S == R2Y_ yuv_YV12 || S == R2Y_ yuv_YVU9)), R2Y_ byte_t *>
 {
-    return in_data + in_size;
+    return in_data + (in_w * in_h);
 }
 
 template <R2Y_ supported S, R2Y_ plane_type P>
-R2Y_FORCE_INLINE_ auto split(R2Y_ byte_t * in_data, GLB_ size_t in_size)
-    -> STD_ enable_if_t<((P == R2Y_ plane_V) && (S == R2Y_ yuv_422P)), R2Y_ byte_t *>
+R2Y_FORCE_INLINE_ auto split(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h)
+    -> STD_ enable_if_t<((P == R2Y_ plane_V) && (S == R2Y_ yuv_YU12 || S == R2Y_ yuv_411P ||
+                                                 S == R2Y_ yuv_422P || S == R2Y_ yuv_YUV9)) ||
+                        ((P == R2Y_ plane_U) && (S == R2Y_ yuv_YV12 || S == R2Y_ yuv_YVU9)), R2Y_ byte_t *>
 {
-    return in_data + in_size + (in_size >> 1);
+    return in_data + (in_w * in_h) + R2Y_ plane_size(in_w, in_h, chroma_sub<S>::x, chroma_sub<S>::y);
 }
 
-template <R2Y_ supported S, R2Y_ plane_type P>
-R2Y_FORCE_INLINE_ auto split(R2Y_ byte_t * in_data, GLB_ size_t in_size)
-    -> STD_ enable_if_t<((P == R2Y_ plane_V) && (S == R2Y_ yuv_YU12 || S == R2Y_ yuv_411P)) ||
-                        ((P == R2Y_ plane_U) && (S == R2Y_ yuv_YV12)), R2Y_ byte_t *>
+template <R2Y_ supported S>
+R2Y_FORCE_INLINE_ auto fill(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h)
+    -> STD_ enable_if_t<(S == R2Y_ yuv_YV12 || S == R2Y_ yuv_YU12 ||
+                         S == R2Y_ yuv_411P || S == R2Y_ yuv_422P ||
+                         S == R2Y_ yuv_YUV9 || S == R2Y_ yuv_YVU9), planar_uv_t<S>>
+
 {
-    return in_data + in_size + (in_size >> 2);
+    return
+    {
+        split<S, R2Y_ plane_U>(in_data, in_w, in_h),
+        split<S, R2Y_ plane_V>(in_data, in_w, in_h)
+    };
 }
 
-template <R2Y_ supported S, R2Y_ plane_type P>
-R2Y_FORCE_INLINE_ auto split(R2Y_ byte_t * in_data, GLB_ size_t in_size)
-    -> STD_ enable_if_t<((P == R2Y_ plane_V) && (S == R2Y_ yuv_YUV9)) ||
-                        ((P == R2Y_ plane_U) && (S == R2Y_ yuv_YVU9)), R2Y_ byte_t *>
-
+template <R2Y_ supported S>
+R2Y_FORCE_INLINE_ auto fill(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h)
+    -> STD_ enable_if_t<(S == R2Y_ yuv_NV24 || S == R2Y_ yuv_NV42 ||
+                         S == R2Y_ yuv_NV12 || S == R2Y_ yuv_NV21), planar_uv_t<S>>
 {
-    return in_data + in_size + (in_size >> 4);
+    return
+    {
+        reinterpret_cast<decltype(STD_ declval<planar_uv_t<S>>().uv_)>(
+            split<R2Y_ yuv_YU12, R2Y_ plane_U>(in_data, in_w, in_h))
+    };
 }
 
-template <R2Y_ supported S>
-R2Y_FORCE_INLINE_ auto fill(R2Y_ byte_t * in_data, GLB_ size_t in_size)
-    -> STD_ enable_if_t<(S == R2Y_ yuv_YV12 || S == R2Y_ yuv_YU12 ||
-                         S == R2Y_ yuv_411P || S == R2Y_ yuv_422P ||
-                         S == R2Y_ yuv_YUV9 || S == R2Y_ yuv_YVU9), planar_uv_t<S>>
+/* The chroma row in_r of a frame given plane by plane */
 
+template <R2Y_ supported S>
+R2Y_FORCE_INLINE_ auto planar_uv_at(R2Y_ frame_planes const & in_f, GLB_ size_t in_r)
+    -> STD_ enable_if_t<(S == R2Y_ yuv_YU12 || S == R2Y_ yuv_411P || S == R2Y_ yuv_422P || S == R2Y_ yuv_YUV9 ||
+                         S == R2Y_ yuv_YV12 || S == R2Y_ yuv_YVU9), planar_uv_t<S>>
 {
+    enum { cb = (S == R2Y_ yuv_YV12 || S == R2Y_ yuv_YVU9) ? 2 : 1, cr = 3 - cb };
     return
     {
-        split<S, R2Y_ plane_U>(in_data, in_size),
-        split<S, R2Y_ plane_V>(in_data, in_size)
+        in_f.data_[cb] + (in_r * in_f.pitch_[cb]),
+        in_f.data_[cr] + (in_r * in_f.pitch_[cr])
     };
 }
 
 template <R2Y_ supported S>
-R2Y_FORCE_INLINE_ auto fill(R2Y_ byte_t * in_data, GLB_ size_t in_size)
+R2Y_FORCE_INLINE_ auto planar_uv_at(R2Y_ frame_planes const & in_f, GLB_ size_t in_r)
     -> STD_ enable_if_t<(S == R2Y_ yuv_NV24 || S == R2Y_ yuv_NV42 ||
                          S == R2Y_ yuv_NV12 || S == R2Y_ yuv_NV21), planar_uv_t<S>>
 {
     return
     {
-        reinterpret_cast<decltype(std::declval<planar_uv_t<S>>().uv_)>(
-            split<R2Y_ yuv_YU12, R2Y_ plane_U>(in_data, in_size))
+        reinterpret_cast<decltype(STD_ declval<planar_uv_t<S>>().uv_)>(in_f.data_[1] + (in_r * in_f.pitch_[1]))
     };
 }
 
@@ -146,10 +190,96 @@ struct yuv_planar
     template <typename Y, typename UV>
     R2Y_FORCE_INLINE_ yuv_planar(Y & y, UV & uv, R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h)
     {
-        GLB_ size_t size = in_w * in_h;
-        y  = split<S, R2Y_ plane_Y>(in_data, size);
-        uv = fill<S>(in_data, size);
+        y  = split<S, R2Y_ plane_Y>(in_data, in_w, in_h);
+        uv = fill<S>(in_data, in_w, in_h);
     }
 };
 
 } // namespace detail_helper_
+
+////////////////////////////////////////////////////////////////
+/// The planes of a tight frame of any format
+////////////////////////////////////////////////////////////////
+
+namespace detail_layout_ {
+
+/*
+ * A plane of a frame: where it begins, the bytes of a row, how many rows,
+ * and how many image rows share one of its rows.
+ */
+struct plane_t
+{
+    GLB_ size_t offset_, row_, rows_, sub_y_;
+};
+
+/* The formats walked in whole rows of a single plane */
+
+template <R2Y_ supported S>
+auto layout(GLB_ size_t in_w, GLB_ size_t in_h, R2Y_ detail_layout_::plane_t (& ot_p)[3])
+    -> STD_ enable_if_t<(S == R2Y_ rgb_888 || S == R2Y_ rgb_565 || S == R2Y_ rgb_555 || S == R2Y_ rgb_888X ||
+                         S == R2Y_ yuv_YUYV || S == R2Y_ yuv_YVYU || S == R2Y_ yuv_UYVY || S == R2Y_ yuv_VYUY ||
+                         S == R2Y_ yuv_Y41P || S == R2Y_ yuv_Y411 || S == R2Y_ yuv_Y800 ||
+                         S == R2Y_ yuv_MB16 || S == R2Y_ yuv_MB32 || S == R2Y_ yuv_MB64 || R2Y_ is_jpg<S>::value), GLB_ size_t>
+{
+    ot_p[0] = { 0, calculate_size<S>(in_w, in_h) / in_h, in_h, 1 };
+    return 1;
+}
+
+template <R2Y_ supported S>
+auto layout(GLB_ size_t in_w, GLB_ size_t in_h, R2Y_ detail_layout_::plane_t (& ot_p)[3])
+    -> STD_ enable_if_t<(S == R2Y_ yuv_422P || S == R2Y_ yuv_YV12 || S == R2Y_ yuv_YU12 ||
+                         S == R2Y_ yuv_411P || S == R2Y_ yuv_YUV9 || S == R2Y_ yuv_YVU9), GLB_ size_t>
+{
+    typedef R2Y_ detail_helper_::chroma_sub<S> sub_t;
+    GLB_ size_t cw = (in_w + sub_t::x - 1) / sub_t::x, ch = (in_h + sub_t::y - 1) / sub_t::y;
+    ot_p[0] = { 0, in_w, in_h, 1 };
+    ot_p[1] = { in_w * in_h, cw, ch, sub_t::y };
+    ot_p[2] = { (in_w * in_h) + (cw * ch), cw, ch, sub_t::y };
+    return 3;
+}
+
+template <R2Y_ supported S>
+auto layout(GLB_ size_t in_w, GLB_ size_t in_h, R2Y_ detail_layout_::plane_t (& ot_p)[3])
+    -> STD_ enable_if_t<(S == R2Y_ yuv_NV24 || S == R2Y_ yuv_NV42 || S == R2Y_ yuv_NV12 || S == R2Y_ yuv_NV21), GLB_ size_t>
+{
+    typedef R2Y_ detail_helper_::chroma_sub<S> sub_t;
+    GLB_ size_t cw = (in_w + sub_t::x - 1) / sub_t::x, ch = (in_h + sub_t::y - 1) / sub_t::y;
+    ot_p[0] = { 0, in_w, in_h, 1 };
+    ot_p[1] = { in_w * in_h, cw * 2, ch, sub_t::y };
+    return 2;
+}
+
+template <R2Y_ supported S>
+auto layout(GLB_ size_t in_w, GLB_ size_t in_h, R2Y_ detail_layout_::plane_t (& ot_p)[3])
+    -> STD_ enable_if_t<(S == R2Y_ yuv_P010), GLB_ size_t>
+{
+    GLB_ size_t cw = (in_w + 1) >> 1, ch = (in_h + 1) >> 1;
+    ot_p[0] = { 0, in_w * sizeof(GLB_ uint16_t), in_h, 1 };
+    ot_p[1] = { in_w * in_h * sizeof(GLB_ uint16_t), cw * 2 * sizeof(GLB_ uint16_t), ch, 2 };
+    return 2;
+}
+
+template <R2Y_ supported S>
+auto layout(GLB_ size_t in_w, GLB_ size_t in_h, R2Y_ detail_layout_::plane_t (& ot_p)[3])
+    -> STD_ enable_if_t<R2Y_ is_ycc<S>::value, GLB_ size_t>
+{
+    GLB_ size_t row = calculate_size<S>(in_w, in_h) / (in_h * 3);
+    for (GLB_ size_t i = 0; i < 3; ++i) ot_p[i] = { row * in_h * i, row, in_h, 1 };
+    return 3;
+}
+
+/* The planes of a tight frame, back to back from in_data */
+template <R2Y_ supported S>
+R2Y_ frame_planes tight_planes(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h)
+{
+    R2Y_ detail_layout_::plane_t p[3];
+    R2Y_ frame_planes ret = {};
+    for (GLB_ size_t i = 0, n = R2Y_ detail_layout_::layout<S>(in_w, in_h, p); i < n; ++i)
+    {
+        ret.data_ [i] = in_data + p[i].offset_;
+        ret.pitch_[i] = p[i].row_;
+    }
+    return ret;
+}
+
+} // namespace detail_layout_
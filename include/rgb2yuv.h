@@ -0,0 +1,100 @@
+/*
+    rgb2yuv - Code covered by the MIT License
+    Author: mutouyun (http://orzz.org)
+*/
+
+/*
+ * The C interface, for shared libraries and foreign function interfaces.
+ * A plan is created once for a pair of formats and a frame geometry,
+ * then executed on caller owned buffers as many times as needed,
+ * without allocating memory or throwing exceptions.
+ *
+ * Build it into one C++ translation unit of the shared library:
+ *     #define R2Y_C_API_IMPLEMENTATION
+ *     #include "rgb2yuv.hpp"
+ */
+
+#ifndef RGB2YUV_H__
+#define RGB2YUV_H__
+
+#include <stddef.h>     /* size_t */
+
+#if !defined(R2Y_API)
+#   if defined(_WIN32) && defined(R2Y_SHARED)
+#       if defined(R2Y_C_API_IMPLEMENTATION)
+#           define R2Y_API __declspec(dllexport)
+#       else
+#           define R2Y_API __declspec(dllimport)
+#       endif
+#   elif defined(__GNUC__) && defined(R2Y_C_API_IMPLEMENTATION)
+#       define R2Y_API __attribute__((visibility("default")))
+#   else
+#       define R2Y_API
+#   endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The values are part of the ABI: new formats are only appended */
+typedef enum r2y_format
+{
+    R2Y_FORMAT_RGB888  = 1,
+    R2Y_FORMAT_RGB565  = 2,     /* input only */
+    R2Y_FORMAT_RGB555  = 3,     /* input only */
+    R2Y_FORMAT_RGB888X = 4,
+    R2Y_FORMAT_NV24    = 5,
+    R2Y_FORMAT_NV42    = 6,
+    R2Y_FORMAT_YUY2    = 7,
+    R2Y_FORMAT_YVYU    = 8,
+    R2Y_FORMAT_UYVY    = 9,
+    R2Y_FORMAT_VYUY    = 10,
+    R2Y_FORMAT_422P    = 11,    /* output only */
+    R2Y_FORMAT_YV12    = 12,
+    R2Y_FORMAT_I420    = 13,
+    R2Y_FORMAT_NV12    = 14,
+    R2Y_FORMAT_NV21    = 15,
+    R2Y_FORMAT_Y800    = 16
+} r2y_format;
+
+typedef enum r2y_status
+{
+    R2Y_OK                =  0,
+    R2Y_ERROR_ARGUMENT    = -1, /* a null pointer, a zero size, or a stride shorter than a row */
+    R2Y_ERROR_UNSUPPORTED = -2, /* the format, or the pair of formats, can not be converted */
+    R2Y_ERROR_NO_MEMORY   = -3
+} r2y_status;
+
+typedef struct r2y_plan r2y_plan;
+
+/*
+ * Get the planes of a tightly packed frame, in memory order (e.g. NV12: Y, CbCr; YV12: Y, Cr, Cb):
+ * the bytes of a row and the rows of each plane.
+ * Returns the count of planes (1 to 3), or a negative r2y_status.
+ */
+R2Y_API int r2y_format_planes(r2y_format fmt, size_t w, size_t h, size_t row_bytes[3], size_t rows[3]);
+
+/*
+ * Plan the conversion of w * h frames from in_fmt to ot_fmt (the same format is a plain copy).
+ * The strides are the bytes between the rows of each plane, in the order of r2y_format_planes.
+ * A null strides means the planes are tightly packed and follow each other,
+ * so only the first plane pointer is read when executing.
+ * Frames with other strides are read and written in place, row by row.
+ */
+R2Y_API int r2y_plan_create(r2y_format in_fmt, r2y_format ot_fmt, size_t w, size_t h,
+                            size_t const * in_strides, size_t const * ot_strides, r2y_plan ** ot_plan);
+
+/*
+ * Convert a frame. The planes are given in the order of r2y_format_planes.
+ * A plan is never changed by executing it, so several threads may execute it at once.
+ */
+R2Y_API int r2y_plan_execute(r2y_plan * plan, void const * const * in_planes, void * const * ot_planes);
+
+R2Y_API void r2y_plan_destroy(r2y_plan * plan);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* RGB2YUV_H__ */
@@ -9,10 +9,33 @@
 #include <stddef.h>     // size_t, ...
 #include <stdint.h>     // uint8_t, ...
 #include <assert.h>     // assert
+#include <stdio.h>      // FILE, fopen, fgets, sscanf, ...
+#include <string.h>     // memcpy, strncmp, ...
+#include <math.h>       // pow, log, sqrt, ...
 #include <new>          // placement new, std::nothrow
-#include <utility>      // std::swap, std::forward, std::move
+#include <utility>      // std::swap, std::forward, std::move, std::index_sequence
+#include <tuple>        // std::tuple
+#include <memory>       // std::shared_ptr
+#include <mutex>        // std::mutex, std::lock_guard
+#include <chrono>       // std::chrono::steady_clock
 #include <type_traits>  // std::enable_if
 
+#if defined(__linux__)
+#include <sys/mman.h>   // mmap, madvise
+#endif
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>  // _mm_crc32_u8, _mm_crc32_u64, ...
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>   // __crc32cb, __crc32cd
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>  // _mm_unpacklo_epi8, _mm_packus_epi16, ...
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>   // vld2q_u8, vst2q_u8, ...
+#endif
+
 #include "detail/predefine.hxx"
 
 namespace R2Y_NAMESPACE_ {
@@ -20,10 +43,21 @@ namespace R2Y_NAMESPACE_ {
 #include "detail/basic_concept.hxx"
 #include "detail/scope_block.hxx"
 #include "detail/buffer_creator.hxx"
+#include "detail/pixel_mask.hxx"
 #include "detail/yuv_helper.hxx"
+#include "detail/plane_helper.hxx"
+#include "detail/bayer_helper.hxx"
+#include "detail/ycc_helper.hxx"
+#include "detail/pixel_checksum.hxx"
+#include "detail/pixel_rows.hxx"
 #include "detail/pixel_iterator.hxx"
 #include "detail/pixel_walker.hxx"
+#include "detail/pixel_scaler.hxx"
+#include "detail/pixel_pipeline.hxx"
+#include "detail/pixel_mosaic.hxx"
 #include "detail/pixel_convertor.hxx"
+#include "detail/color_lut.hxx"
+#include "detail/hdr_convertor.hxx"
 
 ////////////////////////////////////////////////////////////////
 /// Transforming between RGB & YUV/YCbCr blocks
@@ -38,35 +72,94 @@ struct do_convert_t
         is_block      = R2Y_ iterator<S>::is_block
     };
 
+    /*
+     * The pixel type the iterator takes.
+     * YCoCg and JPEG block iterators take RGB pixels and do their own integer transforms.
+     */
+    typedef STD_ conditional_t<R2Y_ is_yuv<S>::value, R2Y_ yuv_t, R2Y_ rgb_t> pixel_t;
+
+    do_convert_t(R2Y_ byte_t * ot_data, GLB_ size_t in_w, GLB_ size_t in_h)
+        : iter_(ot_data, in_w, in_h)
+    {}
+
     do_convert_t(R2Y_ scope_block<R2Y_ byte_t> & ot_data, GLB_ size_t in_w, GLB_ size_t in_h)
         : iter_(ot_data.data(), in_w, in_h)
     {}
 
-    template <typename T, int> struct convert_pixel_t;
-    template <int Dummy>       struct convert_pixel_t<R2Y_ rgb_t, Dummy> { typedef R2Y_ yuv_t type; };
-    template <int Dummy>       struct convert_pixel_t<R2Y_ yuv_t, Dummy> { typedef R2Y_ rgb_t type; };
+    /* Planes of any pitch, only for the iterators taking them (see frame_planes) */
+    do_convert_t(R2Y_ frame_planes const & ot_f, GLB_ size_t in_w, GLB_ size_t in_h)
+        : iter_(ot_f, in_w, in_h)
+    {}
+
+    R2Y_FORCE_INLINE_ static pixel_t const & convert(pixel_t const & pix) { return pix; }
+
+    template <typename T>
+    R2Y_FORCE_INLINE_ static pixel_t convert(T const & pix) { return pixel_convert(pix); }
 
     template <typename T>
     void operator()(T const & pix)
     {
-        iter_.set_and_next(pixel_convert(pix));
+        iter_.set_and_next(convert(pix));
+    }
+
+    /* The walker has produced what the iterator takes, no conversion needed */
+    template <GLB_ size_t N>
+    void operator()(pixel_t const (& pix)[N])
+    {
+        iter_.set_and_next(pix);
     }
 
     template <typename T, GLB_ size_t N>
     void operator()(T const (& pix)[N])
     {
-        typename convert_pixel_t<T, 0>::type c_pix[N];
+        pixel_t c_pix[N];
         for (GLB_ size_t i = 0; i < N; ++i)
         {
-            c_pix[i] = pixel_convert(pix[i]);
+            c_pix[i] = convert(pix[i]);
         }
         iter_.set_and_next(c_pix);
     }
 
-private:
+protected:
     R2Y_ iterator<S> iter_;
 };
 
+/*
+ * do_convert_t taking planar rows from the walkers fetching rgb_t or yuv_t (see detail_rows_),
+ * so the colors are converted a plane at a time instead of a pixel at a time.
+ * Only for the iterators taking the rows as they are (with a set_rows),
+ * the others (e.g. YUY2, 422P, P010, MB64) still take the pixels one step at a time.
+ */
+template <R2Y_ supported S>
+struct do_planar_t : R2Y_ do_convert_t<S>
+{
+    typedef R2Y_ do_convert_t<S> base_t;
+    typedef typename base_t::pixel_t pixel_t;
+
+    enum
+    {
+        is_planar = R2Y_ detail_rows_::has_set_rows<R2Y_ iterator<S>, pixel_t,
+                                                    (base_t::is_block ? base_t::iterator_size : 1)>::value
+    };
+
+    using base_t::base_t;
+    using base_t::operator();
+
+    template <int R, GLB_ size_t N>
+    void operator()(R2Y_ detail_rows_::planar_rows<pixel_t, R, N> const & rows, GLB_ size_t n)
+    {
+        R2Y_ detail_rows_::set_rows(this->iter_, rows, n);
+    }
+
+    template <typename P, int R, GLB_ size_t N>
+    void operator()(R2Y_ detail_rows_::planar_rows<P, R, N> const & rows, GLB_ size_t n)
+    {
+        R2Y_ detail_rows_::planar_rows<pixel_t, R, N> c_rows;
+        R2Y_ pixel_convert(rows, c_rows, n);
+        R2Y_ detail_rows_::set_rows(this->iter_, c_rows, n);
+    }
+};
+
 template <R2Y_ supported In, R2Y_ supported Ot>
 STD_ enable_if_t<(In != Ot), R2Y_ scope_block<R2Y_ byte_t>>
     transform(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h)
@@ -75,12 +168,876 @@ STD_ enable_if_t<(In != Ot), R2Y_ scope_block<R2Y_ byte_t>>
     assert(in_w > 0 && in_h > 0);
 
     R2Y_ scope_block<R2Y_ byte_t> ot_data{ create_buffer<Ot>(in_w, in_h) };
-    R2Y_ pixel_foreach<In>(in_data, in_w, in_h, R2Y_ do_convert_t<Ot>{ ot_data, in_w, in_h });
+    R2Y_ pixel_foreach<In>(in_data, in_w, in_h, R2Y_ do_planar_t<Ot>{ ot_data, in_w, in_h });
+    return ot_data;
+}
+
+////////////////////////////////////////////////////////////////
+/// Transforming to several formats in one pass
+////////////////////////////////////////////////////////////////
+
+template <R2Y_ supported> using frame_of = R2Y_ scope_block<R2Y_ byte_t>;
+
+/* The output a fan-out walks for: the first one walked in blocks, otherwise the first one */
+
+template <R2Y_ supported S, R2Y_ supported... Ss>
+struct walk_of
+{
+    static constexpr R2Y_ supported value = S;
+};
+
+template <R2Y_ supported S, R2Y_ supported S1, R2Y_ supported... Ss>
+struct walk_of<S, S1, Ss...>
+{
+    static constexpr R2Y_ supported value = R2Y_ iterator<S>::is_block ? S : R2Y_ walk_of<S1, Ss...>::value;
+};
+
+/*
+ * An output walked in rows (e.g. Y800, YUY2, NV24), fed by a walk of another shape:
+ * the steps of R rows x K pixels are gathered into R rows of the frame,
+ * which are handed to the output a step of its own at a time once they are complete.
+ * The pixels the walk replicates past the right and bottom edges are dropped here,
+ * and the output replicates its own at the end of a row.
+ */
+template <R2Y_ supported S, int R, int K>
+class do_rows_t
+{
+    typedef R2Y_ do_convert_t<S>    conv_t;
+    typedef typename conv_t::pixel_t pixel_t;
+
+    enum { step = conv_t::iterator_size };
+
+    conv_t                    conv_;
+    R2Y_ scope_block<pixel_t> rows_;
+    GLB_ size_t               w_, h_, x_, y_;
+
+    template <int N = step>
+    R2Y_FORCE_INLINE_ auto put(pixel_t const * row, GLB_ size_t /*x*/) -> STD_ enable_if_t<(N == 1)>
+    {
+        conv_(*row);
+    }
+
+    template <int N = step>
+    R2Y_FORCE_INLINE_ auto put(pixel_t const * row, GLB_ size_t x) -> STD_ enable_if_t<(N > 1)>
+    {
+        pixel_t pix[N];
+        for (GLB_ size_t i = 0; i < N; ++i)
+        {
+            pix[i] = row[((x + i) < w_) ? i : (w_ - 1 - x)];
+        }
+        conv_(pix);
+    }
+
+    void flush(void)
+    {
+        for (int r = 0; (r < R) && ((y_ + r) < h_); ++r)
+        {
+            pixel_t const * row = rows_.data() + (r * w_);
+            for (GLB_ size_t x = 0; x < w_; x += step) this->put(row + x, x);
+        }
+        x_ = 0;
+        y_ += R;
+    }
+
+public:
+    do_rows_t(R2Y_ scope_block<R2Y_ byte_t> & ot_data, GLB_ size_t in_w, GLB_ size_t in_h)
+        : conv_(ot_data, in_w, in_h), rows_(R * in_w), w_(in_w), h_(in_h), x_(0), y_(0)
+    {}
+
+    void operator()(pixel_t const & pix)
+    {
+        rows_[x_] = pix;
+        if (++x_ >= w_) this->flush();
+    }
+
+    void operator()(pixel_t const (& pix)[R * K])
+    {
+        GLB_ size_t n = ((x_ + K) <= w_) ? K : (w_ - x_);
+        for (int r = 0; r < R; ++r)
+        {
+            memcpy(rows_.data() + (r * w_) + x_, pix + (r * K), n * sizeof(pixel_t));
+        }
+        x_ += K;
+        if (x_ >= w_) this->flush();
+    }
+};
+
+template <R2Y_ supported... Ss>
+struct do_fanout_t
+{
+    typedef R2Y_ do_convert_t<R2Y_ walk_of<Ss...>::value> walk_t;
+    typedef typename walk_t::pixel_t                      pixel_t;
+
+    enum
+    {
+        iterator_size = walk_t::iterator_size,
+        is_block      = walk_t::is_block
+    };
+
+    /* The outputs of the same shape are fed directly, the ones walked in rows through do_rows_t */
+    template <R2Y_ supported X> struct conv_of
+    {
+        enum
+        {
+            same = (static_cast<int>(R2Y_ iterator<X>::iterator_size) == static_cast<int>(iterator_size)) &&
+                   (static_cast<int>(R2Y_ iterator<X>::is_block)      == static_cast<int>(is_block)),
+            value = (same || !R2Y_ iterator<X>::is_block) &&
+                    STD_ is_same<typename R2Y_ do_convert_t<X>::pixel_t, pixel_t>::value
+        };
+
+        typedef STD_ conditional_t<same, R2Y_ do_convert_t<X>,
+                                   R2Y_ do_rows_t<X, (is_block ? iterator_size : 1), iterator_size>> type;
+    };
+
+    static_assert(R2Y_ all_of<conv_of<Ss>::value...>::value,
+                  "The outputs of a fan-out must share the pixel type, and at most one block shape.");
+
+    do_fanout_t(STD_ tuple<R2Y_ frame_of<Ss>...> & ot_data, GLB_ size_t in_w, GLB_ size_t in_h)
+        : do_fanout_t(ot_data, in_w, in_h, STD_ make_index_sequence<sizeof...(Ss)>{})
+    {}
+
+    /* Each pixel is converted once, then shared by all the outputs */
+    template <typename T>
+    void operator()(T const & pix)
+    {
+        this->dispatch(walk_t::convert(pix), STD_ make_index_sequence<sizeof...(Ss)>{});
+    }
+
+    template <typename T, GLB_ size_t N>
+    void operator()(T const (& pix)[N])
+    {
+        pixel_t c_pix[N];
+        for (GLB_ size_t i = 0; i < N; ++i)
+        {
+            c_pix[i] = walk_t::convert(pix[i]);
+        }
+        this->dispatch(c_pix, STD_ make_index_sequence<sizeof...(Ss)>{});
+    }
+
+private:
+    template <GLB_ size_t... I>
+    do_fanout_t(STD_ tuple<R2Y_ frame_of<Ss>...> & ot_data, GLB_ size_t in_w, GLB_ size_t in_h, STD_ index_sequence<I...>)
+        : convs_(typename conv_of<Ss>::type{ STD_ get<I>(ot_data), in_w, in_h }...)
+    {}
+
+    template <typename P, GLB_ size_t... I>
+    void dispatch(P const & c_pix, STD_ index_sequence<I...>)
+    {
+        int swallow[] = { (STD_ get<I>(convs_)(c_pix), 0)... };
+        static_cast<void>(swallow);
+    }
+
+    STD_ tuple<typename conv_of<Ss>::type...> convs_;
+};
+
+/*
+ * One read of the input drives all the outputs,
+ * e.g. auto ot = transform<rgb_888X, yuv_NV12, yuv_I420, yuv_Y800>(in_data, in_w, in_h);
+ *      STD_ get<0>(ot) is the NV12 frame, STD_ get<1>(ot) the I420 one, ...
+ */
+template <R2Y_ supported In, R2Y_ supported Ot, R2Y_ supported Ot1, R2Y_ supported... Ots>
+STD_ tuple<R2Y_ frame_of<Ot>, R2Y_ frame_of<Ot1>, R2Y_ frame_of<Ots>...>
+    transform(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h)
+{
+    assert(in_data != NULL);
+    assert(in_w > 0 && in_h > 0);
+
+    STD_ tuple<R2Y_ frame_of<Ot>, R2Y_ frame_of<Ot1>, R2Y_ frame_of<Ots>...> ot_data
+    {
+        create_buffer<Ot>(in_w, in_h), create_buffer<Ot1>(in_w, in_h), create_buffer<Ots>(in_w, in_h)...
+    };
+    R2Y_ pixel_foreach<In>(in_data, in_w, in_h, R2Y_ do_fanout_t<Ot, Ot1, Ots...>{ ot_data, in_w, in_h });
+    return ot_data;
+}
+
+////////////////////////////////////////////////////////////////
+/// Transforming to a ladder of scaled renditions in one pass
+////////////////////////////////////////////////////////////////
+
+/*
+ * e.g. rung ladder[] = { { 1920, 1080, f1080 }, { 1280, 720, f720 }, { 854, 480, f480 }, { 640, 360, f360 } };
+ *      transform<rgb_888X, yuv_NV12>(in_data, 3840, 2160, ladder, 4);
+ * Returns false if out of memory, then the frames are left untouched.
+ */
+template <R2Y_ supported In, R2Y_ supported Ot>
+STD_ enable_if_t<(R2Y_ is_rgb<In>::value || R2Y_ is_bayer<In>::value || R2Y_ is_ycc<In>::value) && (In != R2Y_ rgb_161616) &&
+                 !R2Y_ is_idx<Ot>::value && !R2Y_ is_bayer<Ot>::value && (Ot != R2Y_ rgb_161616) && (Ot != R2Y_ yuv_P010), bool>
+    transform(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, R2Y_ rung const * rungs, GLB_ size_t count)
+{
+    assert(in_data != NULL);
+    assert(in_w > 0 && in_h > 0);
+    assert(rungs != NULL && count > 0);
+
+    return R2Y_ ladder_foreach<In, R2Y_ do_convert_t<Ot>>(in_data, in_w, in_h, rungs, count);
+}
+
+////////////////////////////////////////////////////////////////
+/// Scaling and transforming against a deadline
+////////////////////////////////////////////////////////////////
+
+/* The quality a frame is scaled at, from the best to the cheapest */
+enum class quality
+{
+    area,   // area averaging, as the ladder does
+    nearest // nearest neighbour sampling
+};
+
+struct frame_report
+{
+    R2Y_ quality              level_;
+    STD_ chrono::nanoseconds elapsed_;
+    bool                      late_;   // finished after the deadline
+};
+
+/*
+ * e.g. realtime_transform<rgb_888X, yuv_NV12> conv{ 1280, 720 };
+ *      frame_report r = conv(in_data, 1920, 1080, ot_data, steady_clock::now() + milliseconds(8));
+ * Each frame is scaled by area averaging, unless the measured rate of it predicts a miss of the deadline,
+ * then the frame is sampled by nearest neighbour instead (also when the deadline has already passed).
+ * The rate of area averaging is measured on the frames it converts; while it is skipped,
+ * the rate is relaxed a little every frame, so it is tried again once the load goes down.
+ * If area averaging is out of memory the frame is sampled as well, and if that is too, ot_data is left untouched.
+ */
+template <R2Y_ supported In, R2Y_ supported Ot>
+class realtime_transform
+{
+    static_assert((R2Y_ is_rgb<In>::value || R2Y_ is_bayer<In>::value || R2Y_ is_ycc<In>::value) && (In != R2Y_ rgb_161616) &&
+                  !R2Y_ is_idx<Ot>::value && !R2Y_ is_bayer<Ot>::value && (Ot != R2Y_ rgb_161616) && (Ot != R2Y_ yuv_P010),
+                  "The formats are not supported by scaling.");
+
+    typedef STD_ chrono::steady_clock clock_type;
+
+    enum { rows = R2Y_ do_convert_t<Ot>::is_block ? R2Y_ do_convert_t<Ot>::iterator_size : 1 };
+
+    GLB_ size_t ot_w_, ot_h_;
+    double      area_ns_; // per source pixel of area averaging, 0 if not measured yet
+
+    static void measure(double & io_ns, clock_type::duration elapsed, GLB_ size_t n)
+    {
+        double ns = static_cast<double>(STD_ chrono::duration_cast<STD_ chrono::nanoseconds>(elapsed).count()) / n;
+        io_ns = (io_ns == 0) ? ns : ((io_ns * 3 + ns) / 4);
+    }
+
+public:
+    realtime_transform(GLB_ size_t ot_w, GLB_ size_t ot_h)
+        : ot_w_(ot_w), ot_h_(ot_h), area_ns_(0)
+    {
+        assert(ot_w > 0 && ot_h > 0);
+        assert((ot_w % R2Y_ do_convert_t<Ot>::iterator_size) == 0);
+    }
+
+    /* The quality the next frame of in_w x in_h would be converted at, if started now */
+    R2Y_ quality predict(GLB_ size_t in_w, GLB_ size_t in_h, clock_type::time_point deadline) const
+    {
+        double budget = static_cast<double>(STD_ chrono::duration_cast<STD_ chrono::nanoseconds>(deadline - clock_type::now()).count());
+        return ((area_ns_ * in_w * in_h) <= budget) ? R2Y_ quality::area : R2Y_ quality::nearest;
+    }
+
+    /* Convert a frame into ot_data (created by the caller, e.g. with create_buffer<Ot>(ot_w, ot_h)) */
+    R2Y_ frame_report operator()(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h,
+                                 R2Y_ byte_t * ot_data, clock_type::time_point deadline)
+    {
+        assert(in_data != NULL && ot_data != NULL);
+        assert(in_w > 0 && in_h > 0);
+
+        R2Y_ quality level = this->predict(in_w, in_h, deadline);
+        clock_type::time_point start = clock_type::now();
+        if (level == R2Y_ quality::area)
+        {
+            R2Y_ rung r = { ot_w_, ot_h_, ot_data };
+            if (!R2Y_ ladder_foreach<In, R2Y_ do_convert_t<Ot>>(in_data, in_w, in_h, &r, 1))
+                level = R2Y_ quality::nearest;
+        }
+        if (level == R2Y_ quality::nearest)
+        {
+            GLB_ size_t in_rows = (rows * ((in_h + ot_h_ - 1) / ot_h_)) + 2;
+            R2Y_ detail_scale_::nearest_pixels<decltype(R2Y_ detail_walker_::make_pixels<In>(in_data, in_w, in_h, in_rows))> get
+            {
+                R2Y_ detail_walker_::make_pixels<In>(in_data, in_w, in_h, in_rows), in_w, in_h, ot_w_, ot_h_
+            };
+            if (get.valid())
+                R2Y_ detail_walker_::foreach_xy(ot_w_, ot_h_, get, R2Y_ do_planar_t<Ot>{ ot_data, ot_w_, ot_h_ });
+        }
+        clock_type::time_point end = clock_type::now();
+
+        if (level == R2Y_ quality::area)
+             measure(area_ns_, end - start, in_w * in_h);
+        else area_ns_ -= area_ns_ / 16;
+        return { level, STD_ chrono::duration_cast<STD_ chrono::nanoseconds>(end - start), (end > deadline) };
+    }
+};
+
+////////////////////////////////////////////////////////////////
+/// Composing many sources into one frame
+////////////////////////////////////////////////////////////////
+
+/*
+ * e.g. tile wall[] =
+ *      {
+ *          make_tile<rgb_888X>(cam0, 1920, 1080,    0, 0, 1920, 1080),
+ *          make_tile<rgb_565 >(cam1, 1280,  720, 1920, 0, 1920, 1080), ...
+ *      };
+ *      compose<yuv_NV12>(wall, 16, ot_data, 3840, 2160);
+ * The tiles are drawn in order (later ones on top), the rest of the frame is filled with the background.
+ * Returns false if out of memory, then ot_data is left untouched.
+ */
+template <R2Y_ supported Ot>
+STD_ enable_if_t<!R2Y_ is_idx<Ot>::value && !R2Y_ is_bayer<Ot>::value && (Ot != R2Y_ rgb_161616) && (Ot != R2Y_ yuv_P010), bool>
+    compose(R2Y_ tile const * tiles, GLB_ size_t count, R2Y_ byte_t * ot_data, GLB_ size_t ot_w, GLB_ size_t ot_h,
+            R2Y_ rgb_t const & background = R2Y_ rgb_t{})
+{
+    assert(ot_data != NULL);
+    assert(ot_w > 0 && ot_h > 0);
+    assert(tiles != NULL || count == 0);
+
+    return R2Y_ mosaic_foreach(tiles, count, ot_w, ot_h, background, R2Y_ do_convert_t<Ot>{ ot_data, ot_w, ot_h });
+}
+
+////////////////////////////////////////////////////////////////
+/// Transforming with the checksums of the output planes
+////////////////////////////////////////////////////////////////
+
+template <R2Y_ supported S>
+struct do_checksum_t : R2Y_ do_convert_t<S>
+{
+    typedef R2Y_ do_convert_t<S> base_t;
+
+    enum { rows = base_t::is_block ? base_t::iterator_size : 1 };
+
+    do_checksum_t(R2Y_ scope_block<R2Y_ byte_t> & ot_data, GLB_ size_t in_w, GLB_ size_t in_h)
+        : base_t(ot_data, in_w, in_h)
+        , hasher_(ot_data.data(), in_w, in_h)
+        , steps_((in_w + base_t::iterator_size - 1) / base_t::iterator_size)
+        , left_(steps_), h_(in_h), y_(0)
+    {}
+
+    template <typename T>
+    void operator()(T const & pix)
+    {
+        base_t::operator()(pix);
+        this->next();
+    }
+
+    template <typename T, GLB_ size_t N>
+    void operator()(T const (& pix)[N])
+    {
+        base_t::operator()(pix);
+        this->next();
+    }
+
+    void result(R2Y_ checksum & ot_sums) const
+    {
+        hasher_.result(ot_sums);
+    }
+
+private:
+    /* A row (or a row of blocks) is finished after steps_ steps, hash it while it is hot */
+    R2Y_FORCE_INLINE_ void next(void)
+    {
+        if (--left_ != 0) return;
+        left_ = steps_;
+        y_ += rows;
+        hasher_.rows_done((y_ < h_) ? y_ : h_);
+    }
+
+    R2Y_ detail_checksum_::plane_hasher<S> hasher_;
+    GLB_ size_t                            steps_, left_, h_, y_;
+};
+
+/*
+ * Nothing is read back after the conversion:
+ * e.g. checksum sums;
+ *      auto nv12 = transform<rgb_888X, yuv_NV12>(in_data, in_w, in_h, sums);
+ *      sums.crc_[0] is the CRC32C of the Y plane, sums.crc_[1] of the CbCr plane.
+ */
+template <R2Y_ supported In, R2Y_ supported Ot>
+STD_ enable_if_t<(In != Ot), R2Y_ scope_block<R2Y_ byte_t>>
+    transform(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, R2Y_ checksum & ot_sums)
+{
+    assert(in_data != NULL);
+    assert(in_w > 0 && in_h > 0);
+
+    R2Y_ scope_block<R2Y_ byte_t> ot_data{ create_buffer<Ot>(in_w, in_h) };
+    R2Y_ do_checksum_t<Ot> conv{ ot_data, in_w, in_h };
+    R2Y_ pixel_foreach<In>(in_data, in_w, in_h, conv);
+    conv.result(ot_sums);
+    return ot_data;
+}
+
+////////////////////////////////////////////////////////////////
+/// Transforming with a hook on the finished rows
+////////////////////////////////////////////////////////////////
+
+/*
+ * The rows of the output just finished, while they are still in the cache:
+ * the image rows [y0_, y1_), and the rows of each plane (in the order of its memory) written for them.
+ * A subsampled chroma plane may have no rows in a group, until the rows sharing them are all written.
+ */
+struct row_group
+{
+    GLB_ size_t   y0_, y1_;
+    GLB_ size_t   count_;    // the count of planes
+    R2Y_ byte_t * data_ [3]; // the first row of each plane in this group
+    GLB_ size_t   pitch_[3]; // the bytes of a row of each plane
+    GLB_ size_t   rows_ [3]; // the rows of each plane in this group
+};
+
+template <R2Y_ supported S, typename F>
+struct do_hook_t : R2Y_ do_planar_t<S>
+{
+    typedef R2Y_ do_planar_t<S> base_t;
+
+    enum { rows = base_t::is_block ? base_t::iterator_size : 1 };
+
+    do_hook_t(R2Y_ scope_block<R2Y_ byte_t> & ot_data, GLB_ size_t in_w, GLB_ size_t in_h, F & hook)
+        : base_t(ot_data, in_w, in_h)
+        , data_(ot_data.data()), count_(R2Y_ detail_layout_::layout<S>(in_w, in_h, planes_))
+        , steps_((in_w + base_t::iterator_size - 1) / base_t::iterator_size)
+        , left_(steps_), h_(in_h), y_(0), hook_(hook)
+    {
+        for (GLB_ size_t i = 0; i < count_; ++i) done_[i] = 0;
+    }
+
+    template <typename T>
+    void operator()(T const & pix)
+    {
+        base_t::operator()(pix);
+        this->next(1);
+    }
+
+    template <typename T, GLB_ size_t N>
+    void operator()(T const (& pix)[N])
+    {
+        base_t::operator()(pix);
+        this->next(1);
+    }
+
+    template <typename P, int R, GLB_ size_t N>
+    void operator()(R2Y_ detail_rows_::planar_rows<P, R, N> const & pix, GLB_ size_t n)
+    {
+        base_t::operator()(pix, n);
+        this->next(n / base_t::iterator_size);
+    }
+
+private:
+    /* A row (or a row of blocks) is finished after steps_ steps */
+    R2Y_FORCE_INLINE_ void next(GLB_ size_t n)
+    {
+        if ((left_ -= n) != 0) return;
+        left_ = steps_;
+        R2Y_ row_group g;
+        g.y0_    = y_;
+        g.y1_    = y_ = (((y_ + rows) < h_) ? (y_ + rows) : h_);
+        g.count_ = count_;
+        for (GLB_ size_t i = 0; i < count_; ++i)
+        {
+            R2Y_ detail_layout_::plane_t const & p = planes_[i];
+            GLB_ size_t end = (y_ + p.sub_y_ - 1) / p.sub_y_;
+            if (end > p.rows_) end = p.rows_;
+            g.data_ [i] = data_ + p.offset_ + (done_[i] * p.row_);
+            g.pitch_[i] = p.row_;
+            g.rows_ [i] = end - done_[i];
+            done_[i]    = end;
+        }
+        hook_(static_cast<R2Y_ row_group const &>(g));
+    }
+
+    R2Y_ byte_t *                  data_;
+    R2Y_ detail_layout_::plane_t planes_[3];
+    GLB_ size_t                    count_, steps_, left_, h_, y_;
+    GLB_ size_t                    done_[3]; // the rows handed out of each plane
+    F &                            hook_;
+};
+
+template <typename F, typename = void>
+struct is_row_hook : STD_ false_type {};
+
+template <typename F>
+struct is_row_hook<F, decltype(void(STD_ declval<F &>()(STD_ declval<R2Y_ row_group const &>())))> : STD_ true_type {};
+
+/*
+ * Post-process the output (e.g. watermarks, defect masks) in the same pass:
+ * e.g. auto nv12 = transform<rgb_888X, yuv_NV12>(in_data, in_w, in_h, [](row_group const & g) { ... });
+ * The hook is called in order as each row (or row of blocks) is written, and may change those rows.
+ */
+template <R2Y_ supported In, R2Y_ supported Ot, typename F>
+STD_ enable_if_t<(In != Ot) && R2Y_ is_row_hook<F>::value &&
+                 !R2Y_ is_idx<Ot>::value && !R2Y_ is_bayer<Ot>::value && (Ot != R2Y_ rgb_161616) && (Ot != R2Y_ yuv_P010),
+                 R2Y_ scope_block<R2Y_ byte_t>>
+    transform(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, F && hook)
+{
+    assert(in_data != NULL);
+    assert(in_w > 0 && in_h > 0);
+
+    R2Y_ scope_block<R2Y_ byte_t> ot_data{ create_buffer<Ot>(in_w, in_h) };
+    R2Y_ pixel_foreach<In>(in_data, in_w, in_h, R2Y_ do_hook_t<Ot, STD_ remove_reference_t<F>>{ ot_data, in_w, in_h, hook });
+    return ot_data;
+}
+
+////////////////////////////////////////////////////////////////
+/// Transforming only the pixels selected by a mask, into an existing frame
+////////////////////////////////////////////////////////////////
+
+template <R2Y_ supported S>
+struct do_mask_t : R2Y_ do_convert_t<S>
+{
+    typedef R2Y_ do_convert_t<S>      base_t;
+    typedef typename base_t::pixel_t pixel_t;
+
+    using base_t::base_t;
+    using base_t::operator();
+
+    template <typename T>
+    void operator()(T const & pix, R2Y_ byte_t a)
+    {
+        this->iter_.blend_and_next(base_t::convert(pix), a);
+    }
+
+    template <typename T, GLB_ size_t N>
+    void operator()(T const (& pix)[N], R2Y_ byte_t const (& a)[N])
+    {
+        pixel_t c_pix[N];
+        for (GLB_ size_t i = 0; i < N; ++i)
+        {
+            c_pix[i] = base_t::convert(pix[i]);
+        }
+        this->iter_.blend_and_next(c_pix, a);
+    }
+
+    void skip(GLB_ size_t n)
+    {
+        this->iter_.skip(n);
+    }
+};
+
+/*
+ * The pixels out of the mask are left untouched in ot_data,
+ * so the cost follows the coverage of the mask.
+ * e.g. transform<rgb_888X, yuv_NV12>(in_data, in_w, in_h, { mask_data, mask_1BIT }, frame)
+ */
+template <R2Y_ supported In, R2Y_ supported Ot>
+STD_ enable_if_t<(R2Y_ is_rgb<In>::value || R2Y_ is_bayer<In>::value || R2Y_ is_ycc<In>::value) && (In != R2Y_ rgb_161616) &&
+                 (Ot == R2Y_ rgb_888  || Ot == R2Y_ rgb_888X ||
+                  Ot == R2Y_ yuv_NV24 || Ot == R2Y_ yuv_NV42 ||
+                  Ot == R2Y_ yuv_YV12 || Ot == R2Y_ yuv_YU12 || Ot == R2Y_ yuv_NV12 || Ot == R2Y_ yuv_NV21)>
+    transform(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, R2Y_ mask const & m, R2Y_ byte_t * ot_data)
+{
+    assert(in_data != NULL);
+    assert(in_w > 0 && in_h > 0);
+    assert(m.data_ != NULL && m.fmt_ < R2Y_ mask_MAX);
+    assert(ot_data != NULL);
+
+    R2Y_ masked_foreach<In>(in_data, in_w, in_h, m, R2Y_ do_mask_t<Ot>{ ot_data, in_w, in_h });
+}
+
+////////////////////////////////////////////////////////////////
+/// Transforming RGB blocks graded by a 3D LUT, in the same pass
+////////////////////////////////////////////////////////////////
+
+template <R2Y_ supported S>
+struct do_grade_t : R2Y_ do_convert_t<S>
+{
+    typedef R2Y_ do_convert_t<S> base_t;
+
+    do_grade_t(R2Y_ scope_block<R2Y_ byte_t> & ot_data, GLB_ size_t in_w, GLB_ size_t in_h, R2Y_ lut3d const & lut)
+        : base_t(ot_data, in_w, in_h), lut_(lut)
+    {}
+
+    void operator()(R2Y_ rgb_t const & pix)
+    {
+        base_t::operator()(lut_(pix));
+    }
+
+    template <GLB_ size_t N>
+    void operator()(R2Y_ rgb_t const (& pix)[N])
+    {
+        R2Y_ rgb_t g_pix[N];
+        for (GLB_ size_t i = 0; i < N; ++i)
+        {
+            g_pix[i] = lut_(pix[i]);
+        }
+        base_t::operator()(g_pix);
+    }
+
+private:
+    R2Y_ lut3d const & lut_;
+};
+
+template <R2Y_ supported In, R2Y_ supported Ot>
+STD_ enable_if_t<(R2Y_ is_rgb<In>::value || R2Y_ is_bayer<In>::value) && R2Y_ is_yuv<Ot>::value, R2Y_ scope_block<R2Y_ byte_t>>
+    transform(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, R2Y_ lut3d const & lut)
+{
+    assert(in_data != NULL);
+    assert(in_w > 0 && in_h > 0);
+    assert(!lut.empty());
+
+    R2Y_ scope_block<R2Y_ byte_t> ot_data{ create_buffer<Ot>(in_w, in_h) };
+    R2Y_ pixel_foreach<In>(in_data, in_w, in_h, R2Y_ do_grade_t<Ot>{ ot_data, in_w, in_h, lut });
     return ot_data;
 }
-    
+
+////////////////////////////////////////////////////////////////
+/// Transforming high bit depth RGB blocks to HDR YUV
+////////////////////////////////////////////////////////////////
+
+template <R2Y_ supported S>
+struct do_hdr_t
+{
+    enum
+    {
+        iterator_size = R2Y_ iterator<S>::iterator_size,
+        is_block      = R2Y_ iterator<S>::is_block
+    };
+
+    do_hdr_t(R2Y_ scope_block<R2Y_ byte_t> & ot_data, GLB_ size_t in_w, GLB_ size_t in_h, R2Y_ transfer tf)
+        : iter_(ot_data.data(), in_w, in_h), conv_(tf)
+    {}
+
+    void operator()(R2Y_ rgb16_t const & pix)
+    {
+        iter_.set_and_next(conv_(pix));
+    }
+
+    template <GLB_ size_t N>
+    void operator()(R2Y_ rgb16_t const (& pix)[N])
+    {
+        R2Y_ yuv16_t c_pix[N];
+        for (GLB_ size_t i = 0; i < N; ++i)
+        {
+            c_pix[i] = conv_(pix[i]);
+        }
+        iter_.set_and_next(c_pix);
+    }
+
+private:
+    R2Y_ iterator<S>     iter_;
+    R2Y_ hdr_convertor   conv_;
+};
+
+/*
+ * 16-bit RGB -> PQ/HLG (or nothing if it's already non-linear) -> BT.2020 YCbCr,
+ * e.g. transform<rgb_161616, yuv_P010>(in_data, in_w, in_h, transfer_PQ)
+ */
+template <R2Y_ supported In, R2Y_ supported Ot>
+STD_ enable_if_t<(In == R2Y_ rgb_161616) && (Ot == R2Y_ yuv_P010), R2Y_ scope_block<R2Y_ byte_t>>
+    transform(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, R2Y_ transfer tf)
+{
+    assert(in_data != NULL);
+    assert(in_w > 0 && in_h > 0);
+    assert(tf < R2Y_ transfer_MAX);
+
+    R2Y_ scope_block<R2Y_ byte_t> ot_data{ create_buffer<Ot>(in_w, in_h) };
+    R2Y_ pixel_foreach<In>(in_data, in_w, in_h, R2Y_ do_hdr_t<Ot>{ ot_data, in_w, in_h, tf });
+    return ot_data;
+}
+
+////////////////////////////////////////////////////////////////
+/// Transforming HDR YUV blocks to SDR, tone mapped in the same pass
+////////////////////////////////////////////////////////////////
+
+template <R2Y_ supported S>
+struct do_tonemap_t : R2Y_ do_convert_t<S>
+{
+    typedef R2Y_ do_convert_t<S> base_t;
+
+    do_tonemap_t(R2Y_ scope_block<R2Y_ byte_t> & ot_data, GLB_ size_t in_w, GLB_ size_t in_h, R2Y_ tone_mapper const & tm)
+        : base_t(ot_data, in_w, in_h), tm_(tm)
+    {}
+
+    void operator()(R2Y_ yuv16_t const & pix)
+    {
+        base_t::operator()(tm_(pix));
+    }
+
+    template <GLB_ size_t N>
+    void operator()(R2Y_ yuv16_t const (& pix)[N])
+    {
+        R2Y_ rgb_t t_pix[N];
+        for (GLB_ size_t i = 0; i < N; ++i)
+        {
+            t_pix[i] = tm_(pix[i]);
+        }
+        base_t::operator()(t_pix);
+    }
+
+private:
+    R2Y_ tone_mapper const & tm_;
+};
+
+/*
+ * e.g. transform<yuv_P010, yuv_NV12>(in_data, in_w, in_h, { transfer_PQ, tonemap_BT2390, 1000, 100 })
+ */
+template <R2Y_ supported In, R2Y_ supported Ot>
+STD_ enable_if_t<(In == R2Y_ yuv_P010) && R2Y_ is_yuv<Ot>::value && (Ot != R2Y_ yuv_P010), R2Y_ scope_block<R2Y_ byte_t>>
+    transform(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, R2Y_ tone_map const & tm)
+{
+    assert(in_data != NULL);
+    assert(in_w > 0 && in_h > 0);
+
+    R2Y_ scope_block<R2Y_ tone_mapper> mapper{ 1 }; // ~20 KB of tables, keep them off the stack
+    if (mapper.data() == NULL) return {};
+    new (mapper.data()) R2Y_ tone_mapper{ tm };
+    R2Y_ scope_block<R2Y_ byte_t> ot_data{ create_buffer<Ot>(in_w, in_h) };
+    R2Y_ pixel_foreach<In>(in_data, in_w, in_h, R2Y_ do_tonemap_t<Ot>{ ot_data, in_w, in_h, mapper[0] });
+    return ot_data;
+}
+
+////////////////////////////////////////////////////////////////
+/// Transforming indexed blocks through a pre-converted palette
+////////////////////////////////////////////////////////////////
+
+template <R2Y_ supported S>
+struct do_lookup_t
+{
+    enum
+    {
+        iterator_size = R2Y_ iterator<S>::iterator_size,
+        is_block      = R2Y_ iterator<S>::is_block
+    };
+
+    typedef STD_ conditional_t<R2Y_ is_yuv<S>::value, R2Y_ yuv_t, R2Y_ rgb_t> pixel_t;
+
+    do_lookup_t(R2Y_ scope_block<R2Y_ byte_t> & ot_data, GLB_ size_t in_w, GLB_ size_t in_h,
+                pixel_t const (& table)[256])
+        : iter_(ot_data.data(), in_w, in_h), table_(table)
+    {}
+
+    void operator()(R2Y_ byte_t const & index)
+    {
+        iter_.set_and_next(table_[index]);
+    }
+
+    template <GLB_ size_t N>
+    void operator()(R2Y_ byte_t const (& index)[N])
+    {
+        pixel_t pix[N];
+        for (GLB_ size_t i = 0; i < N; ++i)
+        {
+            pix[i] = table_[index[i]];
+        }
+        iter_.set_and_next(pix);
+    }
+
+private:
+    R2Y_ iterator<S> iter_;
+    pixel_t const (& table_)[256];
+};
+
+R2Y_FORCE_INLINE_ void palette_convert(R2Y_ rgb_t const & in_p, R2Y_ yuv_t & ot_p) { ot_p = pixel_convert(in_p); }
+R2Y_FORCE_INLINE_ void palette_convert(R2Y_ rgb_t const & in_p, R2Y_ rgb_t & ot_p) { ot_p = in_p; }
+
+/*
+ * The palette is converted once, so each pixel costs a single lookup.
+ * Indices out of the palette are mapped to black.
+ */
+template <R2Y_ supported In, R2Y_ supported Ot>
+STD_ enable_if_t<R2Y_ is_idx<In>::value && !R2Y_ is_idx<Ot>::value, R2Y_ scope_block<R2Y_ byte_t>>
+    transform(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h,
+              R2Y_ rgb_t const * palette, GLB_ size_t count)
+{
+    assert(in_data != NULL);
+    assert(in_w > 0 && in_h > 0);
+    assert(palette != NULL);
+    assert(count > 0 && count <= 256);
+
+    typename R2Y_ do_lookup_t<Ot>::pixel_t table[256];
+    for (GLB_ size_t i = 0; i < 256; ++i)
+    {
+        R2Y_ palette_convert((i < count) ? palette[i] : R2Y_ rgb_t{ 0, 0, 0 }, table[i]);
+    }
+
+    R2Y_ scope_block<R2Y_ byte_t> ot_data{ create_buffer<Ot>(in_w, in_h) };
+    R2Y_ pixel_foreach<In>(in_data, in_w, in_h, R2Y_ do_lookup_t<Ot>{ ot_data, in_w, in_h, table });
+    return ot_data;
+}
+
+////////////////////////////////////////////////////////////////
+/// Running a pipeline of stages in one pass
+////////////////////////////////////////////////////////////////
+
+/* The end of a pipeline: the format to convert into */
+template <R2Y_ supported Ot>
+struct sink {};
+
+template <R2Y_ supported Ot>
+auto to(void)
+    -> STD_ enable_if_t<!R2Y_ is_idx<Ot>::value && !R2Y_ is_bayer<Ot>::value && (Ot != R2Y_ rgb_161616) && (Ot != R2Y_ yuv_P010),
+                        R2Y_ sink<Ot>>
+{
+    return {};
+}
+
+/*
+ * A pipeline ended with a format, run by calling it with the source frame
+ * (and a checksum, to get the CRC32C of each output plane in the same pass):
+ * the stages fetch from each other by (x, y), and the last one is walked and converted once.
+ */
+template <R2Y_ supported Ot, typename P>
+class pipeline_plan
+{
+    P pipe_;
+
+    R2Y_ scope_block<R2Y_ byte_t> run(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h, R2Y_ checksum * ot_sums) const
+    {
+        assert(in_data != NULL);
+        assert(in_w > 0 && in_h > 0);
+
+        enum { rows = R2Y_ do_convert_t<Ot>::is_block ? R2Y_ do_convert_t<Ot>::iterator_size : 1 };
+        GLB_ size_t ot_w = in_w, ot_h = in_h;
+        pipe_.size(ot_w, ot_h);
+        R2Y_ scope_block<R2Y_ byte_t> ot_data{ create_buffer<Ot>(ot_w, ot_h) };
+        pipe_.fetch(in_data, in_w, in_h, rows, [&ot_data, ot_sums](auto & get, GLB_ size_t w, GLB_ size_t h)
+        {
+            if (ot_sums == NULL)
+            {
+                R2Y_ detail_walker_::foreach_xy(w, h, get, R2Y_ do_planar_t<Ot>{ ot_data, w, h });
+                return;
+            }
+            R2Y_ do_checksum_t<Ot> conv{ ot_data, w, h };
+            R2Y_ detail_walker_::foreach_xy(w, h, get, conv);
+            conv.result(*ot_sums);
+        });
+        return ot_data;
+    }
+
+public:
+    pipeline_plan(P const & pipe, R2Y_ sink<Ot> const & /*s*/)
+        : pipe_(pipe)
+    {}
+
+    /* The size of the output frame */
+    void size(GLB_ size_t & io_w, GLB_ size_t & io_h) const
+    {
+        pipe_.size(io_w, io_h);
+    }
+
+    R2Y_ scope_block<R2Y_ byte_t> operator()(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h) const
+    {
+        return this->run(in_data, in_w, in_h, NULL);
+    }
+
+    R2Y_ scope_block<R2Y_ byte_t> operator()(R2Y_ byte_t * in_data, GLB_ size_t in_w, GLB_ size_t in_h,
+                                            R2Y_ checksum & ot_sums) const
+    {
+        return this->run(in_data, in_w, in_h, &ot_sums);
+    }
+};
+
+template <R2Y_ supported S, typename... Stages, R2Y_ supported Ot>
+R2Y_ pipeline_plan<Ot, R2Y_ pipeline<S, Stages...>>
+    operator|(R2Y_ pipeline<S, Stages...> const & p, R2Y_ sink<Ot> const & s)
+{
+    return { p, s };
+}
+
+#include "detail/tile_view.hxx"
+
 } // namespace R2Y_NAMESPACE_
 
+#if defined(R2Y_C_API_IMPLEMENTATION)
+#include "detail/c_api.hxx"
+#endif
+
 #include "detail/undefine.hxx"
 
 #endif // RGB2YUV_HPP__
@@ -3,7 +3,9 @@
 
 #include <stdio.h>
 #include <cstring>
+#include <thread>
 
+#define R2Y_C_API_IMPLEMENTATION
 #include "../include/rgb2yuv.hpp"
 
 #include "stopwatch.hpp"
@@ -102,6 +104,484 @@ int main(int /*argc*/, char* /*argv*/[])
     TEST_(YUV9);
     TEST_(YVU9);
 
+    {
+        rgb_t palette[] = { { 0x21, 0x42, 0x63 }, { 0x63, 0x42, 0x21 }, { 0x80, 0x80, 0x80 } };
+        uint8_t index[] =
+        {
+            0, 1, 1, 1,
+            1, 2, 1, 1,
+            1, 1, 1, 1,
+            1, 1, 1, 2
+        };
+        yuv = transform<idx_8, yuv_YV12>(index, 4, 4, palette, 3);
+        printf("IDX-8 -> YV12: ");
+        for (size_t i = 0; i < yuv.count(); ++i) printf("%02X ", yuv[i]);
+        printf("\n");
+    }
+    {
+        float cube[2 * 2 * 2 * 3]; // a 2x2x2 LUT which inverts the colors
+        for (int i = 0; i < 8; ++i)
+        {
+            cube[i * 3    ] = (i & 1) ? 0.0f : 1.0f;
+            cube[i * 3 + 1] = (i & 2) ? 0.0f : 1.0f;
+            cube[i * 3 + 2] = (i & 4) ? 0.0f : 1.0f;
+        }
+        lut3d lut;
+        lut.reset(2, cube);
+        yuv = transform<rgb_888X, yuv_YV12>((uint8_t*)data, 4, 4, lut);
+        printf("888X (inverted by LUT) -> YV12: ");
+        for (size_t i = 0; i < yuv.count(); ++i) printf("%02X ", yuv[i]);
+        printf("\n");
+        float d_min[3] = { 0.0f, 0.0f, 0.0f }, d_max[3] = { 1.0f, 0.0f, 1.0f }; // an empty green domain
+        bool rejected = !lut.reset(2, cube, d_min, d_max);
+        auto same = transform<rgb_888X, yuv_YV12>((uint8_t*)data, 4, 4, lut);
+        printf("LUT with a bad domain: %s, %s\n", rejected ? "rejected" : "accepted",
+               (memcmp(same.data(), yuv.data(), yuv.size()) == 0) ? "kept" : "changed");
+    }
+    {
+        rgb16_t hdr[16];
+        for (size_t i = 0; i < 16; ++i) // 100 cd/m2 grey, with a peak white
+        {
+            hdr[i].r_ = hdr[i].g_ = hdr[i].b_ = static_cast<uint16_t>((i == 0) ? 65535 : 655);
+        }
+        yuv = transform<rgb_161616, yuv_P010>((uint8_t*)hdr, 4, 4, transfer_PQ);
+        printf("161616 -> P010 (PQ): ");
+        for (size_t i = 0; i < yuv.count(); i += 2) printf("%03X ", (yuv[i] | (yuv[i + 1] << 8)) >> 6);
+        printf("\n");
+        auto sdr = transform<yuv_P010, yuv_NV12>(yuv.data(), 4, 4, { transfer_PQ, tonemap_BT2390, 1000, 100 });
+        printf("P010 (PQ) -> NV12 (BT.2390): ");
+        for (size_t i = 0; i < sdr.count(); ++i) printf("%02X ", sdr[i]);
+        printf("\n");
+    }
+    {
+        uint8_t raw[] = // RGGB, with r = 0x21, g = 0x42, b = 0x63
+        {
+            0x21, 0x42, 0x21, 0x42,
+            0x42, 0x63, 0x42, 0x63,
+            0x21, 0x42, 0x21, 0x42,
+            0x42, 0x63, 0x42, 0x63
+        };
+        yuv = transform<bayer_RGGB, yuv_NV12>(raw, 4, 4);
+        printf("RGGB -> NV12: ");
+        for (size_t i = 0; i < yuv.count(); ++i) printf("%02X ", yuv[i]);
+        printf("\n");
+        uint8_t raw10[20];
+        for (size_t i = 0; i < 4; ++i)
+        {
+            memcpy(raw10 + i * 5, raw + i * 4, 4);
+            raw10[i * 5 + 4] = 0x55; // every low bits are 01
+        }
+        yuv = transform<bayer_RGGB10, yuv_NV12>(raw10, 4, 4);
+        printf("RGGB10 -> NV12: ");
+        for (size_t i = 0; i < yuv.count(); ++i) printf("%02X ", yuv[i]);
+        printf("\n");
+    }
+
+    uint32_t big[32 * 32]; // a 32x32 888X pattern, for the formats walked in large blocks
+    for (size_t i = 0; i < 32 * 32; ++i) big[i] = static_cast<uint32_t>((i * 2654435761u) >> 8);
+
+    {
+        // the 2x2 blocks of a 444 image, against the same image fed as 888X
+        auto nv12 = transform<rgb_444, yuv_NV12>((uint8_t*)big, 8, 6);
+        auto x888 = transform<rgb_444, rgb_888X>((uint8_t*)big, 8, 6);
+        yuv = transform<rgb_888X, yuv_NV12>(x888.data(), 8, 6);
+        printf("444 (8x6) -> NV12: %s\n",
+               ((nv12.size() == yuv.size()) && (memcmp(nv12.data(), yuv.data(), yuv.size()) == 0)) ? "same as 888X" : "different");
+    }
+    {
+        // the 2-pixel runs of an 888 image, against the same image fed as 888X
+        auto yuy2 = transform<rgb_888, yuv_YUY2>((uint8_t*)big, 8, 6);
+        auto x888 = transform<rgb_888, rgb_888X>((uint8_t*)big, 8, 6);
+        yuv = transform<rgb_888X, yuv_YUY2>(x888.data(), 8, 6);
+        printf("888 (8x6) -> YUY2: %s\n",
+               ((yuy2.size() == yuv.size()) && (memcmp(yuy2.data(), yuv.data(), yuv.size()) == 0)) ? "same as 888X" : "different");
+    }
+    {
+        // planar rows (do_planar_t) against the pixels one by one (do_convert_t),
+        // 30 pixels a row, so the 16-pixel SIMD steps of each run leave a tail
+        auto nv12 = transform<rgb_888X, yuv_NV12>((uint8_t*)big, 30, 30);
+        bool same = true;
+#define PLANAR_(IN, TO, IN_DATA)                                                        \
+        {                                                                               \
+            scope_block<uint8_t> rows{ calculate_size<TO>(30, 30) }, one{ rows.count() }; \
+            memset(rows.data(), 0, rows.size());                                        \
+            memset(one .data(), 0, one .size());                                        \
+            pixel_foreach<IN>(IN_DATA, 30, 30, do_planar_t <TO>{ rows, 30, 30 });       \
+            pixel_foreach<IN>(IN_DATA, 30, 30, do_convert_t<TO>{ one , 30, 30 });       \
+            same = same && (memcmp(rows.data(), one.data(), one.size()) == 0);          \
+        }
+        PLANAR_(yuv_NV12, rgb_888 , nv12.data());
+        PLANAR_(yuv_NV12, rgb_888X, nv12.data());
+        PLANAR_(rgb_888 , yuv_NV12, (uint8_t*)big);
+        PLANAR_(rgb_888X, yuv_NV24, (uint8_t*)big);
+        PLANAR_(rgb_888X, yuv_NV42, (uint8_t*)big);
+        PLANAR_(rgb_888X, yuv_YV12, (uint8_t*)big);
+        PLANAR_(rgb_888X, yuv_YU12, (uint8_t*)big);
+        PLANAR_(rgb_888X, yuv_NV12, (uint8_t*)big);
+        PLANAR_(rgb_888X, yuv_NV21, (uint8_t*)big);
+        PLANAR_(rgb_888X, yuv_Y800, (uint8_t*)big);
+        PLANAR_(rgb_888X, yuv_YUY2, (uint8_t*)big); // no set_rows, so walked pixel by pixel
+        PLANAR_(rgb_888X, yuv_Y41P, (uint8_t*)big);
+        PLANAR_(rgb_888X, yuv_422P, (uint8_t*)big);
+#undef PLANAR_
+        printf("30x30 -> 888, 888X, NV24, NV42, YV12, YU12, NV12, NV21, Y800, YUY2, Y41P, 422P: planar rows %s\n",
+               same ? "same as one by one" : "different");
+    }
+    {
+        // odd sizes, against the frame padded by its edge pixels, converted and cropped back
+        auto pad = [](auto const * in, size_t w, size_t h, size_t pw, size_t ph) // in: 32 pixels a row
+        {
+            scope_block<std::decay_t<decltype(*in)>> ot{ pw * ph };
+            for (size_t y = 0; y < ph; ++y)
+                for (size_t x = 0; x < pw; ++x)
+                    ot[(y * pw) + x] = in[(((y < h) ? y : (h - 1)) * 32) + ((x < w) ? x : (w - 1))];
+            return ot;
+        };
+        // rows bytes of a, each row_a apart, against the same rows of b, each row_b apart
+        auto cropped = [](uint8_t const * a, size_t row_a, uint8_t const * b, size_t row_b, size_t rows, size_t bytes)
+        {
+            for (size_t y = 0; y < rows; ++y)
+                if (memcmp(a + (y * row_a), b + (y * row_b), bytes) != 0) return false;
+            return true;
+        };
+        auto odd = pad(big, 7, 5, 7, 5), even = pad(big, 7, 5, 16, 6);
+        auto one = transform<rgb_888X, yuv_YUY2>((uint8_t*)odd.data(), 7, 5), all = transform<rgb_888X, yuv_YUY2>((uint8_t*)even.data(), 16, 6);
+        bool same = cropped(one.data(), 4 * 4, all.data(), 8 * 4, 5, 4 * 4);
+        one = transform<rgb_888X, yuv_VYUY>((uint8_t*)odd.data(), 7, 5), all = transform<rgb_888X, yuv_VYUY>((uint8_t*)even.data(), 16, 6);
+        same = same && cropped(one.data(), 4 * 4, all.data(), 8 * 4, 5, 4 * 4);
+        one = transform<rgb_888X, yuv_Y41P>((uint8_t*)odd.data(), 7, 5), all = transform<rgb_888X, yuv_Y41P>((uint8_t*)even.data(), 16, 6);
+        same = same && cropped(one.data(), 1 * 12, all.data(), 2 * 12, 5, 1 * 12);
+        one = transform<rgb_888X, yuv_Y411>((uint8_t*)odd.data(), 7, 5), all = transform<rgb_888X, yuv_Y411>((uint8_t*)even.data(), 16, 6);
+        same = same && cropped(one.data(), 2 * 6, all.data(), 4 * 6, 5, 2 * 6);
+        auto odd16 = pad((rgb16_t*)big, 7, 5, 7, 5), even16 = pad((rgb16_t*)big, 7, 5, 8, 6);
+        one = transform<rgb_161616, yuv_P010>((uint8_t*)odd16.data(), 7, 5, transfer_PQ);
+        all = transform<rgb_161616, yuv_P010>((uint8_t*)even16.data(), 8, 6, transfer_PQ);
+        same = same && cropped(one.data(), 7 * 2, all.data(), 8 * 2, 5, 7 * 2)                                // Y
+                    && cropped(one.data() + (7 * 5 * 2), 4 * 4, all.data() + (8 * 6 * 2), 4 * 4, 3, 4 * 4); // UV
+        printf("7x5 -> YUY2, VYUY, Y41P, Y411 (888X), P010 (161616): %s\n", same ? "same as padded, cropped" : "different");
+    }
+    {
+        // full range YCbCr: the ICT planes reblocked, Cb Cr averaged over 2x2 for MCU420
+        auto mcu444 = transform<rgb_888X, jpg_MCU444>((uint8_t*)big, 32, 32);
+        auto mcu420 = transform<rgb_888X, jpg_MCU420>((uint8_t*)big, 32, 32);
+        auto ict    = transform<rgb_888X, ycc_ICT   >((uint8_t*)big, 32, 32);
+        int16_t const * y = reinterpret_cast<int16_t const *>(ict.data()), * cb = y + (32 * 32), * cr = cb + (32 * 32);
+        auto avg = [](int16_t const * c, size_t x, size_t y) // the 2x2 at (x, y) * 2
+        {
+            size_t i = (y * 2 * 32) + (x * 2);
+            return static_cast<int16_t>((c[i] + c[i + 1] + c[i + 32] + c[i + 33] + 2) >> 2);
+        };
+        bool same444 = true, same420 = true;
+        int16_t const * blk = reinterpret_cast<int16_t const *>(mcu444.data());
+        for (size_t my = 0; my < 32; my += 8)
+        {
+            for (size_t mx = 0; mx < 32; mx += 8, blk += (64 * 3))
+            {
+                for (size_t i = 0; i < 64; ++i)
+                {
+                    size_t k = ((my + (i >> 3)) * 32) + mx + (i & 7);
+                    same444 = same444 && (blk[i] == y[k]) && (blk[64 + i] == cb[k]) && (blk[128 + i] == cr[k]);
+                }
+            }
+        }
+        blk = reinterpret_cast<int16_t const *>(mcu420.data());
+        for (size_t my = 0; my < 32; my += 16)
+        {
+            for (size_t mx = 0; mx < 32; mx += 16, blk += (64 * 6))
+            {
+                for (size_t i = 0; i < 64 * 4; ++i) // Y0 Y1 Y2 Y3, then Cb, Cr
+                {
+                    size_t b = i >> 6, r = (i >> 3) & 7, c = i & 7;
+                    size_t yx = mx + ((b & 1) << 3) + c, yy = my + ((b >> 1) << 3) + r;
+                    same420 = same420 && (blk[i] == y[(yy * 32) + yx]);
+                }
+                for (size_t i = 0; i < 64; ++i)
+                {
+                    size_t cx = (mx >> 1) + (i & 7), cy = (my >> 1) + (i >> 3);
+                    same420 = same420 && (blk[256 + i] == avg(cb, cx, cy)) && (blk[320 + i] == avg(cr, cx, cy));
+                }
+            }
+        }
+        printf("888X (32x32) -> MCU444, MCU420: %s, %s as ICT reblocked\n",
+               same444 ? "same" : "different", same420 ? "same" : "different");
+    }
+    {
+        auto mb   = transform<rgb_888X, yuv_MB16>((uint8_t*)big, 32, 32);
+        auto nv12 = transform<rgb_888X, yuv_NV12>((uint8_t*)big, 32, 32);
+        uint8_t const * blk = mb.data(), * y = nv12.data(), * uv = y + (32 * 32);
+        bool same = true;
+        for (size_t by = 0; by < 32; by += 16)
+        {
+            for (size_t bx = 0; bx < 32; bx += 16, blk += (16 * 16 + 8 * 16))
+            {
+                for (size_t r = 0; r < 16; ++r) // Y, then CbCr of the block
+                {
+                    same = same && (memcmp(blk + (r * 16), y + ((by + r) * 32) + bx, 16) == 0);
+                }
+                for (size_t r = 0; r < 8; ++r)
+                {
+                    same = same && (memcmp(blk + 256 + (r * 16), uv + (((by >> 1) + r) * 32) + bx, 16) == 0);
+                }
+            }
+        }
+        printf("888X (32x32) -> MB16: %s as NV12 reordered by macroblock\n", same ? "same" : "different");
+    }
+    {
+        auto ycc = transform<rgb_888X, ycc_YCoCgR>((uint8_t*)data, 4, 4);
+        auto rgb = transform<ycc_YCoCgR, rgb_888>(ycc.data(), 4, 4);
+        auto ref = transform<rgb_888X, rgb_888>((uint8_t*)data, 4, 4);
+        printf("888X -> YCoCg-R -> 888: %s\n", (memcmp(rgb.data(), ref.data(), ref.size()) == 0) ? "lossless" : "mismatch");
+        ycc = transform<rgb_888X, ycc_RCT>((uint8_t*)data, 4, 4);
+        rgb = transform<ycc_RCT, rgb_888>(ycc.data(), 4, 4);
+        printf("888X -> RCT -> 888: %s\n", (memcmp(rgb.data(), ref.data(), ref.size()) == 0) ? "lossless" : "mismatch");
+        ycc = transform<rgb_888X, ycc_ICT>((uint8_t*)data, 4, 4);
+        printf("888X -> ICT: ");
+        for (size_t i = 0; i < 16 * 3; ++i) printf("%d ", reinterpret_cast<int16_t*>(ycc.data())[i]);
+        printf("\n");
+        ycc = transform<rgb_888X, ycc_YCoCg>((uint8_t*)data, 4, 4);
+        printf("888X -> YCoCg: ");
+        for (size_t i = 0; i < ycc.count(); ++i) printf("%02X ", ycc[i]);
+        printf("\n");
+    }
+    {
+        uint8_t bits[] = { 0x60, 0x60, 0x00, 0x00 }; // a 2x2 box at (1, 0)
+        auto frame = transform<rgb_888X, rgb_888>((uint8_t*)data, 4, 4);
+        memset(frame.data(), 0, frame.size());
+        transform<rgb_888X, rgb_888>((uint8_t*)data, 4, 4, { bits, mask_1BIT }, frame.data());
+        printf("888X -> 888 masked: ");
+        for (size_t i = 0; i < frame.count(); ++i) printf("%02X ", frame[i]);
+        printf("\n");
+    }
+    {
+        auto ot = transform<rgb_888X, yuv_NV12, yuv_I420, yuv_Y800>((uint8_t*)data, 4, 4);
+        yuv = transform<rgb_888X, yuv_NV12>((uint8_t*)data, 4, 4);
+        printf("888X -> NV12 + I420 + Y800: NV12 %s, Y800: ",
+               (memcmp(std::get<0>(ot).data(), yuv.data(), yuv.size()) == 0) ? "same" : "different");
+        for (size_t i = 0; i < std::get<2>(ot).count(); ++i) printf("%02X ", std::get<2>(ot)[i]);
+        printf("\n");
+    }
+    {
+        // odd sizes, the row outputs are fed in the steps of the block output
+        auto ot = transform<rgb_888X, yuv_YUY2, yuv_YUV9, yuv_Y800, yuv_NV24>((uint8_t*)big, 7, 5);
+        auto yuy2 = transform<rgb_888X, yuv_YUY2>((uint8_t*)big, 7, 5);
+        auto yuv9 = transform<rgb_888X, yuv_YUV9>((uint8_t*)big, 7, 5);
+        auto y800 = transform<rgb_888X, yuv_Y800>((uint8_t*)big, 7, 5);
+        auto nv24 = transform<rgb_888X, yuv_NV24>((uint8_t*)big, 7, 5);
+        printf("888X (7x5) -> YUY2 + YUV9 + Y800 + NV24: %s\n",
+               ((memcmp(std::get<0>(ot).data(), yuy2.data(), yuy2.size()) == 0) &&
+                (memcmp(std::get<1>(ot).data(), yuv9.data(), yuv9.size()) == 0) &&
+                (memcmp(std::get<2>(ot).data(), y800.data(), y800.size()) == 0) &&
+                (memcmp(std::get<3>(ot).data(), nv24.data(), nv24.size()) == 0)) ? "same as apart" : "different");
+    }
+    {
+        scope_block<uint8_t> full{ calculate_size<yuv_NV12>(4, 4) }, half{ calculate_size<yuv_NV12>(2, 2) };
+        rung ladder[] = { { 4, 4, full.data() }, { 2, 2, half.data() } };
+        transform<rgb_888X, yuv_NV12>((uint8_t*)data, 4, 4, ladder, 2);
+        yuv = transform<rgb_888X, yuv_NV12>((uint8_t*)data, 4, 4);
+        printf("888X -> NV12 ladder: 4x4 %s, 2x2: ",
+               (memcmp(full.data(), yuv.data(), yuv.size()) == 0) ? "same" : "different");
+        for (size_t i = 0; i < half.count(); ++i) printf("%02X ", half[i]);
+        printf("\n");
+    }
+    {
+        tile wall[] =
+        {
+            make_tile<rgb_888X>((uint8_t*)data, 4, 4, 0, 0, 4, 4),
+            make_tile<rgb_888X>((uint8_t*)data, 4, 4, 4, 0, 2, 2)
+        };
+        scope_block<uint8_t> frame{ calculate_size<yuv_NV12>(8, 4) };
+        compose<yuv_NV12>(wall, 2, frame.data(), 8, 4);
+        printf("888X x 2 -> NV12 mosaic: ");
+        for (size_t i = 0; i < frame.count(); ++i) printf("%02X ", frame[i]);
+        printf("\n");
+        // a tile failing to open is left out
+        scope_block<uint8_t> alone{ frame.count() };
+        compose<yuv_NV12>(wall, 1, alone.data(), 8, 4);
+        wall[1].open_ = [](tile const &) -> detail_mosaic_::row_source * { return NULL; };
+        compose<yuv_NV12>(wall, 2, frame.data(), 8, 4);
+        printf("888X x 2 -> NV12 mosaic, a tile failing to open: %s\n",
+               (memcmp(frame.data(), alone.data(), alone.size()) == 0) ? "left out" : "different");
+    }
+    {
+        checksum sums;
+        yuv = transform<rgb_888X, yuv_NV12>((uint8_t*)data, 4, 4, sums);
+        printf("888X -> NV12 CRC32C:");
+        for (size_t i = 0; i < sums.count_; ++i) printf(" %08X", sums.crc_[i]);
+        printf("\n");
+    }
+    {
+        // 16x10 has 40 chroma samples, for both the SIMD body (16 a time) and the tail
+        auto i420 = transform<rgb_888X, yuv_I420>((uint8_t*)big, 16, 10);
+        yuv = transform<rgb_888X, yuv_NV12>((uint8_t*)big, 16, 10);
+        uint8_t uv[80], u[40], v[40];
+        interleave<yuv_NV12>(i420.data() + 160, i420.data() + 200, uv, 40);
+        deinterleave<yuv_NV12>(uv, u, v, 40);
+        printf("I420 -> NV12 interleaved: %s, deinterleaved: %s\n",
+               (memcmp(uv, yuv.data() + 160, 80) == 0) ? "same" : "different",
+               (memcmp(u, i420.data() + 160, 40) == 0 && memcmp(v, i420.data() + 200, 40) == 0) ? "same" : "different");
+    }
+    {
+        size_t strides[2] = { 8, 8 }; // NV12 4x4 in rows of 8 bytes
+        uint8_t y_plane[8 * 4], uv_plane[8 * 2];
+        const void * in_planes[1] = { data };
+        void * ot_planes[2] = { y_plane, uv_plane };
+        r2y_plan * plan = NULL;
+        int ret = r2y_plan_create(R2Y_FORMAT_RGB888X, R2Y_FORMAT_NV12, 4, 4, NULL, strides, &plan);
+        if (ret == R2Y_OK) ret = r2y_plan_execute(plan, in_planes, ot_planes);
+        r2y_plan_destroy(plan);
+        yuv = transform<rgb_888X, yuv_NV12>((uint8_t*)data, 4, 4);
+        bool same = (ret == R2Y_OK);
+        for (size_t i = 0; i < 4; ++i) same = same && (memcmp(y_plane  + (i * 8), yuv.data() + (i * 4), 4) == 0);
+        for (size_t i = 0; i < 2; ++i) same = same && (memcmp(uv_plane + (i * 8), yuv.data() + 16 + (i * 4), 4) == 0);
+        printf("888X -> NV12 C plan (stride 8): %s\n", same ? "same" : "different");
+    }
+    {
+        // odd sizes in strided planes, read and written in place: against the tight frames
+        uint32_t src[7 * 5];
+        for (size_t y = 0; y < 5; ++y) memcpy(src + (y * 7), big + (y * 32), 7 * 4);
+        auto nv12 = transform<rgb_888X, yuv_NV12>((uint8_t*)src, 7, 5);
+        uint8_t in_y[9 * 5], in_uv[10 * 3], ot[3][40 * 5];
+        for (size_t y = 0; y < 5; ++y) memcpy(in_y  + (y * 9),  nv12.data() + (y * 7), 7);
+        for (size_t y = 0; y < 3; ++y) memcpy(in_uv + (y * 10), nv12.data() + 35 + (y * 8), 8);
+        auto run = [&](r2y_format in_fmt, const void * const * in_planes, size_t const * in_strides,
+                       r2y_format ot_fmt, uint8_t const * tight, size_t px = 0) // px: 888X, whose X is never written
+        {
+            size_t ot_strides[3] = { 40, 40, 40 }, row[3], rows[3];
+            void * ot_planes[3] = { ot[0], ot[1], ot[2] };
+            memset(ot, 0xEE, sizeof(ot));
+            r2y_plan * plan = NULL;
+            int ret = r2y_plan_create(in_fmt, ot_fmt, 7, 5, in_strides, ot_strides, &plan);
+            if (ret == R2Y_OK) ret = r2y_plan_execute(plan, in_planes, ot_planes);
+            r2y_plan_destroy(plan);
+            bool same = (ret == R2Y_OK);
+            for (int i = 0, n = r2y_format_planes(ot_fmt, 7, 5, row, rows); i < n; ++i)
+            {
+                for (size_t y = 0; y < rows[i]; ++y, tight += row[i])
+                {
+                    for (size_t x = 0; x < row[i]; ++x)
+                    {
+                        same = same && (((px != 0) && ((x % px) == px - 1)) || (ot[i][(y * 40) + x] == tight[x]));
+                    }
+                    same = same && (ot[i][(y * 40) + row[i]] == 0xEE); // nothing past the row
+                }
+            }
+            return same;
+        };
+        const void * rgb_planes[1] = { big };
+        const void * nv12_planes[2] = { in_y, in_uv };
+        size_t rgb_strides[1] = { 32 * 4 }, nv12_strides[2] = { 9, 10 };
+        bool same = run(R2Y_FORMAT_RGB888X, rgb_planes, rgb_strides, R2Y_FORMAT_NV12, nv12.data());
+        same = same && run(R2Y_FORMAT_NV12, nv12_planes, nv12_strides, R2Y_FORMAT_YUY2,
+                           transform<yuv_NV12, yuv_YUY2>(nv12.data(), 7, 5).data());
+        same = same && run(R2Y_FORMAT_NV12, nv12_planes, nv12_strides, R2Y_FORMAT_YV12,
+                           transform<yuv_NV12, yuv_YV12>(nv12.data(), 7, 5).data());
+        same = same && run(R2Y_FORMAT_NV12, nv12_planes, nv12_strides, R2Y_FORMAT_RGB888X,
+                           transform<yuv_NV12, rgb_888X>(nv12.data(), 7, 5).data(), 4);
+        printf("7x5 888X, NV12 -> NV12, YUY2, YV12, 888X C plans (strided): %s\n", same ? "same" : "different");
+    }
+    {
+        rgb_t palette[20];
+        yuv_t batch[20];
+        for (size_t i = 0; i < 20; ++i) palette[i] = { uint8_t(i * 13), uint8_t(255 - i * 7), uint8_t(i * 11) };
+        pixel_convert(palette, batch, 20);
+        bool same = true;
+        for (size_t i = 0; i < 20; ++i)
+        {
+            yuv_t one = pixel_convert(palette[i]);
+            same = same && (memcmp(&batch[i], &one, sizeof(yuv_t)) == 0);
+        }
+        printf("rgb_t[20] -> yuv_t[20] batch: %s\n", same ? "same" : "different");
+    }
+    {
+        // the 8x8 at (6, 3) of the 32x32 pattern, against the same pixels copied out first
+        checksum sums, ref_sums;
+        auto half = from<rgb_888X>() | crop(6, 3, 8, 8) | downscale<2>() | to<yuv_NV12>();
+        yuv = half((uint8_t*)big, 32, 32, sums);
+        uint32_t part[8 * 8];
+        for (size_t y = 0; y < 8; ++y) memcpy(part + (y * 8), big + ((y + 3) * 32) + 6, 8 * 4);
+        auto ref = (from<rgb_888X>() | downscale<2>() | to<yuv_NV12>())((uint8_t*)part, 8, 8, ref_sums);
+        printf("888X -> crop -> 1/2 -> NV12: ");
+        for (size_t i = 0; i < yuv.count(); ++i) printf("%02X ", yuv[i]);
+        printf("CRC32C: %08X %08X, %s\n", sums.crc_[0], sums.crc_[1],
+               ((memcmp(yuv.data(), ref.data(), ref.size()) == 0) &&
+                (memcmp(sums.crc_, ref_sums.crc_, sums.count_ * sizeof(uint32_t)) == 0)) ? "same as copied" : "different");
+    }
+    {
+        size_t groups = 0, chroma = 0;
+        yuv = transform<rgb_888X, yuv_NV12>((uint8_t*)data, 4, 4, [&](row_group const & g)
+        {
+            ++groups;
+            chroma += g.rows_[1];
+            g.data_[0][0] = 0x10; // mark the first luma of each row group
+        });
+        printf("888X -> NV12 row hook: %zu groups, %zu chroma rows, Y[0] Y[8]: %02X %02X\n", groups, chroma, yuv[0], yuv[8]);
+    }
+    {
+        lazy_view<rgb_888X, yuv_NV12> view{ (uint8_t*)data, 4, 4, 2, 2, 2 };
+        auto t = view.tile(1, 1);
+        view.tile(0, 0);
+        view.tile(1, 1);
+        view.tile(1, 0); // drops (0, 0), t is still held
+        yuv = (from<rgb_888X>() | crop(2, 2, 2, 2) | to<yuv_NV12>())((uint8_t*)data, 4, 4);
+        uint64_t hits = 0, misses = 0;
+        view.stats(hits, misses);
+        printf("888X -> NV12 lazy view: %zu x %zu tiles, tile (1, 1) %s, %llu hits %llu misses\n",
+               view.tiles_x(), view.tiles_y(), (memcmp(t->data_.data(), yuv.data(), yuv.count()) == 0) ? "same" : "different",
+               (unsigned long long)hits, (unsigned long long)misses);
+    }
+    {
+        // 4 threads reading 8x8 tiles of 4x4 through a cache of 16, against the tiles converted apart
+        lazy_view<rgb_888X, yuv_NV12> view{ (uint8_t*)big, 32, 32, 4, 4, 16 };
+        scope_block<uint8_t> tiles[64];
+        for (size_t i = 0; i < 64; ++i)
+        {
+            tiles[i] = (from<rgb_888X>() | crop((i % 8) * 4, (i / 8) * 4, 4, 4) | to<yuv_NV12>())((uint8_t*)big, 32, 32);
+        }
+        bool same[4] = {};
+        std::thread readers[4];
+        for (size_t k = 0; k < 4; ++k)
+        {
+            readers[k] = std::thread{ [&view, &tiles, &same, k]
+            {
+                same[k] = true;
+                for (size_t n = 0; n < 1000; ++n)
+                {
+                    size_t i = ((n * (k * 2 + 1)) + (n / 7)) % 64; // each thread in its own order
+                    auto t = view.tile(i % 8, i / 8);
+                    same[k] = same[k] && t && (memcmp(t->data_.data(), tiles[i].data(), tiles[i].size()) == 0);
+                }
+            } };
+        }
+        for (auto & r : readers) r.join();
+        uint64_t hits = 0, misses = 0;
+        view.stats(hits, misses);
+        printf("888X -> NV12 lazy view, 4 threads: %s, %s\n",
+               (same[0] && same[1] && same[2] && same[3]) ? "same" : "different",
+               ((hits + misses) == 4000) ? "all counted" : "miscounted");
+    }
+    {
+        realtime_transform<rgb_888X, yuv_NV12> conv{ 2, 2 };
+        auto half = create_buffer<yuv_NV12>(2, 2);
+        auto soon = std::chrono::steady_clock::now() + std::chrono::hours(1);
+        frame_report r0 = conv((uint8_t*)data, 4, 4, half.data(), soon);
+        printf("888X -> 1/2 NV12 realtime: level %d: ", (int)r0.level_);
+        for (size_t i = 0; i < half.count(); ++i) printf("%02X ", half[i]);
+        frame_report r1 = conv((uint8_t*)data, 4, 4, half.data(), std::chrono::steady_clock::now()); // already due
+        printf("level %d: ", (int)r1.level_);
+        for (size_t i = 0; i < half.count(); ++i) printf("%02X ", half[i]);
+        printf("\n");
+    }
+    {
+        yuv = transform<rgb_888X, yuv_NV12>((uint8_t*)data, 3, 3);
+        printf("888X (3x3) -> NV12: ");
+        for (size_t i = 0; i < yuv.count(); ++i) printf("%02X ", yuv[i]);
+        printf("\n");
+        auto rgb = transform<yuv_NV12, rgb_888>(yuv.data(), 3, 3);
+        printf("## NV12 (3x3) -> 888: ");
+        for (size_t i = 0; i < rgb.count(); ++i) printf("%02X ", rgb[i]);
+        printf("\n");
+    }
+
     simple::stopwatch<> sw(false);
     printf("\n");
 #define TEST_SPEED_(TO, ...)                                                    \
@@ -119,5 +599,30 @@ int main(int /*argc*/, char* /*argv*/[])
     TEST_SPEED_(411P);
     TEST_SPEED_(Y41P);
 
+    printf("\n");
+#define TEST_ALLOC_(ALLOC)                                                         \
+    sw.start();                                                                    \
+    for (int i = 0; i < 20; ++i)                                                   \
+    {                                                                              \
+        scope_block<uint8_t, ALLOC> frame{ calculate_size<yuv_NV12>(7680, 4320) }; \
+        memset(frame.data(), i, frame.size());                                     \
+        for (size_t n = 0; n < frame.size(); n += 7680 * 2 + 4096) ++frame[n];     \
+    }                                                                              \
+    printf("8K NV12 with %s: %ld ms.\n", #ALLOC, static_cast<size_t>(sw.value() * 1000))
+
+    TEST_ALLOC_(allocator);
+    TEST_ALLOC_(huge_allocator);
+    {
+        // the small blocks come from the heap, still cache line aligned
+        bool aligned = true;
+        for (size_t n = 1; n <= 4096; n = n * 3 + 1)
+        {
+            scope_block<uint8_t, huge_allocator> block{ n };
+            memset(block.data(), 0xCC, block.size());
+            aligned = aligned && ((reinterpret_cast<uintptr_t>(block.data()) % 64) == 0);
+        }
+        printf("huge_allocator, small blocks: %s\n", aligned ? "64-byte aligned" : "misaligned");
+    }
+
     return 0;
 }